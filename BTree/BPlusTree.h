@@ -0,0 +1,671 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "./NodeSearch.h"
+
+
+namespace btree {
+    /*
+     * B+ 树: 每个节点占 NodeBytes 字节(默认 256, 即 4 条缓存行), 元素只存放在叶子中,
+     * 叶子之间用双向链表相连。与 RedBlackTree 每个元素一个节点相比, 一次查找只访问 log_B(n) 个节点,
+     * 每个节点内的 key 连续存放, 节点内查找见 NodeSearch.h。
+     *
+     * 接口与 RedBlackTree 的集合用法一致, key 唯一: insert 在 key 已存在时返回 false。
+     * 内部节点的分隔 key sep[i] 是子树 i 中所有 key 的上界: 子树 i 的 key <= sep[i] < 子树 i + 1 的 key,
+     * 因此下降时子树下标就是节点内小于目标 key 的分隔 key 个数。
+     * 内部节点记录整棵子树的元素个数, select / rank 沿一条根到叶子的路径完成, 每层读取孩子节点头中的个数;
+     * 个数放在孩子自己的节点里而不是父节点的数组中, 内部节点的扇出只少一个 key。
+     * 元素需要可默认构造与移动赋值; 不是线程安全的。
+     */
+    template<typename T, typename Compare = std::less<>, typename KeyOf = Identity, std::size_t NodeBytes = 256>
+    class BPlusTree {
+    public:
+        using key_type = std::remove_cvref_t<std::invoke_result_t<const KeyOf&, const T&>>;
+        using value_type = T;
+        using size_type = std::size_t;
+        using key_compare = Compare;
+
+    private:
+        struct NodeHeader {
+            std::uint32_t count = 0;    // 叶子为元素个数, 内部节点为分隔 key 个数(孩子数减一)
+            bool leaf;
+            explicit NodeHeader(bool is_leaf) : leaf(is_leaf) {}
+        };
+
+        static constexpr std::size_t capacity(std::size_t payload, std::size_t slot) {
+            return payload / slot > 3 ? payload / slot : 3;
+        }
+
+    public:
+        static constexpr std::size_t LEAF_CAP =
+            capacity(NodeBytes - sizeof(NodeHeader) - 2 * sizeof(void*), sizeof(T));
+        static constexpr std::size_t INNER_CAP =
+            capacity(NodeBytes - sizeof(NodeHeader) - sizeof(void*) - sizeof(std::size_t),
+                     sizeof(key_type) + sizeof(void*));
+
+    private:
+        // 分裂后两半都不少于下限, 合并后也不会超过上限
+        static constexpr std::size_t LEAF_MIN = LEAF_CAP / 2;
+        static constexpr std::size_t INNER_MIN = (INNER_CAP - 1) / 2;
+
+        struct alignas(64) Leaf : NodeHeader {
+            T items[LEAF_CAP];
+            Leaf* prev = nullptr;
+            Leaf* next = nullptr;
+            Leaf() : NodeHeader(true) {}
+        };
+
+        struct alignas(64) Inner : NodeHeader {
+            key_type keys[INNER_CAP];
+            NodeHeader* children[INNER_CAP + 1];
+            std::size_t total = 0;      // 子树中的元素个数
+            Inner() : NodeHeader(false) {}
+        };
+
+        NodeHeader* root;
+        Leaf* head;                 // 最左叶子
+        Leaf* tail;                 // 最右叶子
+        std::size_t count = 0;
+        std::size_t leaf_count = 0;
+        std::size_t inner_count = 0;
+        int height = 1;             // 根到叶子的层数, 只有一个叶子时为 1
+
+        static constexpr int MAX_HEIGHT = 64;       // 每个内部节点至少两个孩子, 层数不会超过 64
+        [[no_unique_address]] Compare comp;
+        [[no_unique_address]] KeyOf key_of;
+
+
+        const key_type& keyOf(const T& item) const { return key_of(item); }
+
+        static Leaf* asLeaf(NodeHeader* node) { return static_cast<Leaf*>(node); }
+        static Inner* asInner(NodeHeader* node) { return static_cast<Inner*>(node); }
+
+        struct KeyProj {
+            template<typename K>
+            const K& operator()(const K& k) const { return k; }
+        };
+
+        template<bool OrEqual, typename Q>
+        std::size_t searchLeaf(const Leaf* leaf, const Q& q) const {
+            return searchNode<OrEqual>(leaf->items, leaf->count, q, comp, key_of);
+        }
+
+        template<bool OrEqual, typename Q>
+        std::size_t searchInner(const Inner* inner, const Q& q) const {
+            return searchNode<OrEqual>(inner->keys, inner->count, q, comp, KeyProj{});
+        }
+
+
+        Leaf* newLeaf() {
+            ++leaf_count;
+            return new Leaf();
+        }
+
+        Inner* newInner() {
+            ++inner_count;
+            return new Inner();
+        }
+
+        void freeNode(NodeHeader* node) {
+            if (node->leaf) {
+                --leaf_count;
+                delete asLeaf(node);
+            }
+            else {
+                --inner_count;
+                delete asInner(node);
+            }
+        }
+
+        // 释放整棵子树, 递归深度为树高
+        void freeSubtree(NodeHeader* node) {
+            if (!node->leaf) {
+                Inner* inner = asInner(node);
+                for (std::size_t i = 0; i <= inner->count; ++i) freeSubtree(inner->children[i]);
+            }
+            freeNode(node);
+        }
+
+        static std::size_t subtreeSize(const NodeHeader* node) {
+            return node->leaf ? node->count : static_cast<const Inner*>(node)->total;
+        }
+
+        static std::size_t childrenSize(const Inner* inner) {
+            std::size_t total = 0;
+            for (std::size_t i = 0; i <= inner->count; ++i) total += subtreeSize(inner->children[i]);
+            return total;
+        }
+
+
+        // 下降到 key 所在的叶子; OrEqual 为 true 时走向第一个大于 key 的元素所在的叶子
+        template<bool OrEqual, typename Q>
+        Leaf* descend(const Q& key) const {
+            NodeHeader* node = root;
+            while (!node->leaf) {
+                Inner* inner = asInner(node);
+                node = inner->children[searchInner<OrEqual>(inner, key)];
+                prefetch(node);
+            }
+            return asLeaf(node);
+        }
+
+
+        // 满的孩子 parent->children[i] 分裂成两个, 新的分隔 key 插入 parent 的位置 i
+        void splitChild(Inner* parent, std::size_t i) {
+            NodeHeader* child = parent->children[i];
+            key_type sep;
+            NodeHeader* right;
+
+            if (child->leaf) {
+                Leaf* l = asLeaf(child);
+                Leaf* r = newLeaf();
+                std::size_t keep = LEAF_CAP / 2;
+                std::move(l->items + keep, l->items + l->count, r->items);
+                r->count = static_cast<std::uint32_t>(l->count - keep);
+                l->count = static_cast<std::uint32_t>(keep);
+
+                r->next = l->next;
+                r->prev = l;
+                if (l->next) l->next->prev = r;
+                else tail = r;
+                l->next = r;
+
+                sep = keyOf(l->items[keep - 1]);
+                right = r;
+            }
+            else {
+                Inner* l = asInner(child);
+                Inner* r = newInner();
+                std::size_t keep = INNER_CAP / 2;
+                sep = std::move(l->keys[keep]);
+                std::move(l->keys + keep + 1, l->keys + l->count, r->keys);
+                std::copy(l->children + keep + 1, l->children + l->count + 1, r->children);
+                r->count = static_cast<std::uint32_t>(l->count - keep - 1);
+                l->count = static_cast<std::uint32_t>(keep);
+                r->total = childrenSize(r);
+                l->total -= r->total;
+                right = r;
+            }
+
+            std::move_backward(parent->keys + i, parent->keys + parent->count, parent->keys + parent->count + 1);
+            std::copy_backward(parent->children + i + 1, parent->children + parent->count + 1,
+                               parent->children + parent->count + 2);
+            parent->keys[i] = std::move(sep);
+            parent->children[i + 1] = right;
+            ++parent->count;
+        }
+
+
+        bool isFull(const NodeHeader* node) const {
+            return node->leaf ? node->count == LEAF_CAP : node->count == INNER_CAP;
+        }
+
+
+        /*
+         * 插入: 自顶向下下降, 遇到满的节点先分裂, 保证到达叶子时叶子有空位, 不需要回溯。
+         * key 已存在时不插入(此前的预先分裂不影响树的合法性)。
+         * 插入成功后再给经过的每个内部节点的元素个数加一。
+         */
+        template<typename U>
+        bool insertItem(U&& item) {
+            const key_type& key = keyOf(item);
+            if (isFull(root)) {
+                Inner* new_root = newInner();
+                new_root->children[0] = root;
+                new_root->total = count;
+                root = new_root;
+                ++height;
+                splitChild(new_root, 0);
+            }
+
+            Inner* path[MAX_HEIGHT];
+            int depth = 0;
+            NodeHeader* node = root;
+            while (!node->leaf) {
+                Inner* inner = asInner(node);
+                std::size_t i = searchInner<false>(inner, key);
+                if (isFull(inner->children[i])) {
+                    splitChild(inner, i);
+                    // 新的分隔 key 是左半部分的上界
+                    if (comp(inner->keys[i], key)) ++i;
+                }
+                path[depth++] = inner;
+                node = inner->children[i];
+            }
+
+            Leaf* leaf = asLeaf(node);
+            std::size_t pos = searchLeaf<false>(leaf, key);
+            if (pos < leaf->count && !comp(key, keyOf(leaf->items[pos]))) return false;
+
+            // 先移动后面的元素再写入, item 可能引用树外的对象, 不会被移动覆盖
+            T value(std::forward<U>(item));
+            std::move_backward(leaf->items + pos, leaf->items + leaf->count, leaf->items + leaf->count + 1);
+            leaf->items[pos] = std::move(value);
+            ++leaf->count;
+            ++count;
+            for (int d = 0; d < depth; ++d) ++path[d]->total;
+            return true;
+        }
+
+
+        // 孩子 parent->children[i] 不足下限: 先向左右兄弟借一个, 兄弟也处于下限时与其合并
+        void rebalance(Inner* parent, std::size_t i) {
+            NodeHeader* child = parent->children[i];
+            std::size_t min = child->leaf ? LEAF_MIN : INNER_MIN;
+            NodeHeader* left = i > 0 ? parent->children[i - 1] : nullptr;
+            NodeHeader* right = i < parent->count ? parent->children[i + 1] : nullptr;
+
+            if (left && left->count > min) {
+                borrowFromLeft(parent, i);
+            }
+            else if (right && right->count > min) {
+                borrowFromRight(parent, i);
+            }
+            else if (left) {
+                merge(parent, i - 1);
+            }
+            else {
+                merge(parent, i);
+            }
+        }
+
+        void borrowFromLeft(Inner* parent, std::size_t i) {
+            NodeHeader* child = parent->children[i];
+            if (child->leaf) {
+                Leaf* c = asLeaf(child);
+                Leaf* l = asLeaf(parent->children[i - 1]);
+                std::move_backward(c->items, c->items + c->count, c->items + c->count + 1);
+                c->items[0] = std::move(l->items[l->count - 1]);
+                ++c->count;
+                --l->count;
+                parent->keys[i - 1] = keyOf(l->items[l->count - 1]);
+            }
+            else {
+                Inner* c = asInner(child);
+                Inner* l = asInner(parent->children[i - 1]);
+                std::move_backward(c->keys, c->keys + c->count, c->keys + c->count + 1);
+                std::copy_backward(c->children, c->children + c->count + 1, c->children + c->count + 2);
+                c->keys[0] = std::move(parent->keys[i - 1]);
+                c->children[0] = l->children[l->count];
+                std::size_t moved = subtreeSize(c->children[0]);
+                c->total += moved;
+                l->total -= moved;
+                parent->keys[i - 1] = std::move(l->keys[l->count - 1]);
+                ++c->count;
+                --l->count;
+            }
+        }
+
+        void borrowFromRight(Inner* parent, std::size_t i) {
+            NodeHeader* child = parent->children[i];
+            if (child->leaf) {
+                Leaf* c = asLeaf(child);
+                Leaf* r = asLeaf(parent->children[i + 1]);
+                c->items[c->count] = std::move(r->items[0]);
+                std::move(r->items + 1, r->items + r->count, r->items);
+                ++c->count;
+                --r->count;
+                parent->keys[i] = keyOf(c->items[c->count - 1]);
+            }
+            else {
+                Inner* c = asInner(child);
+                Inner* r = asInner(parent->children[i + 1]);
+                c->keys[c->count] = std::move(parent->keys[i]);
+                c->children[c->count + 1] = r->children[0];
+                std::size_t moved = subtreeSize(r->children[0]);
+                c->total += moved;
+                r->total -= moved;
+                parent->keys[i] = std::move(r->keys[0]);
+                std::move(r->keys + 1, r->keys + r->count, r->keys);
+                std::copy(r->children + 1, r->children + r->count + 1, r->children);
+                ++c->count;
+                --r->count;
+            }
+        }
+
+        // 把 parent->children[i + 1] 并入 parent->children[i], 并从 parent 中删去分隔 key i
+        void merge(Inner* parent, std::size_t i) {
+            NodeHeader* left = parent->children[i];
+            NodeHeader* right = parent->children[i + 1];
+            if (left->leaf) {
+                Leaf* l = asLeaf(left);
+                Leaf* r = asLeaf(right);
+                std::move(r->items, r->items + r->count, l->items + l->count);
+                l->count += r->count;
+                l->next = r->next;
+                if (r->next) r->next->prev = l;
+                else tail = l;
+            }
+            else {
+                Inner* l = asInner(left);
+                Inner* r = asInner(right);
+                l->keys[l->count] = std::move(parent->keys[i]);
+                std::move(r->keys, r->keys + r->count, l->keys + l->count + 1);
+                std::copy(r->children, r->children + r->count + 1, l->children + l->count + 1);
+                l->count += r->count + 1;
+                l->total += r->total;
+            }
+            freeNode(right);
+
+            // 合并后子树 i 的上界变为原来子树 i + 1 的上界, 即删去分隔 key i 后原位置上的 key
+            std::move(parent->keys + i + 1, parent->keys + parent->count, parent->keys + i);
+            std::copy(parent->children + i + 2, parent->children + parent->count + 1, parent->children + i + 1);
+            --parent->count;
+        }
+
+
+        template<typename Q>
+        bool removeFrom(NodeHeader* node, const Q& key) {
+            if (node->leaf) {
+                Leaf* leaf = asLeaf(node);
+                std::size_t pos = searchLeaf<false>(leaf, key);
+                if (pos == leaf->count || comp(key, keyOf(leaf->items[pos]))) return false;
+                std::move(leaf->items + pos + 1, leaf->items + leaf->count, leaf->items + pos);
+                --leaf->count;
+                leaf->items[leaf->count] = T();     // 释放被移走元素持有的资源
+                return true;
+            }
+
+            Inner* inner = asInner(node);
+            std::size_t i = searchInner<false>(inner, key);
+            if (!removeFrom(inner->children[i], key)) return false;
+            --inner->total;
+            NodeHeader* child = inner->children[i];
+            if (child->count < (child->leaf ? LEAF_MIN : INNER_MIN)) rebalance(inner, i);
+            return true;
+        }
+
+
+        /*
+         * 由每个节点的 (节点, 子树最大 key) 自底向上建立一层内部节点, 孩子尽量平均分配,
+         * 使每个节点都不少于下限。
+         */
+        std::vector<std::pair<NodeHeader*, key_type>> buildLevel(std::vector<std::pair<NodeHeader*, key_type>>& level) {
+            std::size_t nodes = (level.size() + INNER_CAP) / (INNER_CAP + 1);
+            std::vector<std::pair<NodeHeader*, key_type>> parents;
+            std::size_t pos = 0;
+            for (std::size_t n = 0; n < nodes; ++n) {
+                std::size_t take = level.size() / nodes + (n < level.size() % nodes ? 1 : 0);
+                Inner* inner = newInner();
+                for (std::size_t j = 0; j < take; ++j) {
+                    inner->children[j] = level[pos + j].first;
+                    if (j + 1 < take) inner->keys[j] = level[pos + j].second;
+                }
+                inner->count = static_cast<std::uint32_t>(take - 1);
+                inner->total = childrenSize(inner);
+                parents.emplace_back(inner, level[pos + take - 1].second);
+                pos += take;
+            }
+            return parents;
+        }
+
+
+    public:
+        // 正向与反向遍历元素的只读迭代器; end() 之后自减得到最大元素
+        class const_iterator {
+        private:
+            friend class BPlusTree;
+            const Leaf* leaf = nullptr;
+            std::size_t pos = 0;
+            const BPlusTree* tree = nullptr;
+
+            const_iterator(const Leaf* l, std::size_t p, const BPlusTree* t) : leaf(l), pos(p), tree(t) {
+                // 位于叶子末尾时移到下一个叶子的开头, 保证每个位置只有一种表示
+                if (leaf && pos == leaf->count) {
+                    leaf = leaf->next;
+                    pos = 0;
+                }
+            }
+
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using reference = const T&;
+            using pointer = const T*;
+
+            const_iterator() = default;
+
+            reference operator*() const { return leaf->items[pos]; }
+            pointer operator->() const { return &leaf->items[pos]; }
+
+            const_iterator& operator++() {
+                if (++pos == leaf->count) {
+                    leaf = leaf->next;
+                    pos = 0;
+                    if (leaf && leaf->next) prefetch(leaf->next);
+                }
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator old = *this;
+                ++*this;
+                return old;
+            }
+
+            const_iterator& operator--() {
+                if (!leaf) {
+                    leaf = tree->tail;
+                    pos = leaf->count - 1;
+                }
+                else if (pos == 0) {
+                    leaf = leaf->prev;
+                    pos = leaf->count - 1;
+                }
+                else {
+                    --pos;
+                }
+                return *this;
+            }
+
+            const_iterator operator--(int) {
+                const_iterator old = *this;
+                --*this;
+                return old;
+            }
+
+            bool operator==(const const_iterator& other) const { return leaf == other.leaf && pos == other.pos; }
+            bool operator!=(const const_iterator& other) const { return !(*this == other); }
+        };
+
+        using iterator = const_iterator;
+
+
+        explicit BPlusTree(const Compare& c = Compare()) : comp(c) {
+            Leaf* leaf = newLeaf();
+            root = leaf;
+            head = tail = leaf;
+        }
+
+        BPlusTree(const BPlusTree&) = delete;
+        BPlusTree& operator=(const BPlusTree&) = delete;
+
+        ~BPlusTree() { freeSubtree(root); }
+
+
+        // 插入元素, key 已存在时返回 false
+        bool insert(const T& val) { return insertItem(val); }
+        bool insert(T&& val) { return insertItem(std::move(val)); }
+
+        template<typename... Args>
+        bool emplace(Args&&... args) { return insertItem(T(std::forward<Args>(args)...)); }
+
+
+        // 删除 key 对应的元素, 返回是否删除
+        template<typename Q>
+        bool remove(const Q& key) {
+            if (!removeFrom(root, key)) return false;
+            --count;
+            // 根只剩一个孩子时降低一层
+            if (!root->leaf && root->count == 0) {
+                NodeHeader* old = root;
+                root = asInner(old)->children[0];
+                freeNode(old);
+                --height;
+            }
+            return true;
+        }
+
+
+        template<typename Q>
+        const_iterator find(const Q& key) const {
+            const Leaf* leaf = descend<false>(key);
+            std::size_t pos = searchLeaf<false>(leaf, key);
+            if (pos < leaf->count && !comp(key, keyOf(leaf->items[pos]))) return const_iterator(leaf, pos, this);
+            return end();
+        }
+
+        // 查找 key 对应的元素, 不存在时返回 nullptr; 指针在下一次修改树之前有效
+        template<typename Q>
+        const T* search(const Q& key) const {
+            const Leaf* leaf = descend<false>(key);
+            std::size_t pos = searchLeaf<false>(leaf, key);
+            if (pos < leaf->count && !comp(key, keyOf(leaf->items[pos]))) return &leaf->items[pos];
+            return nullptr;
+        }
+
+        template<typename Q>
+        bool contains(const Q& key) const {
+            const Leaf* leaf = descend<false>(key);
+            std::size_t pos = searchLeaf<false>(leaf, key);
+            return pos < leaf->count && !comp(key, keyOf(leaf->items[pos]));
+        }
+
+        // 第一个不小于 key 的元素
+        template<typename Q>
+        const_iterator lower_bound(const Q& key) const {
+            const Leaf* leaf = descend<false>(key);
+            return const_iterator(leaf, searchLeaf<false>(leaf, key), this);
+        }
+
+        // 第一个大于 key 的元素
+        template<typename Q>
+        const_iterator upper_bound(const Q& key) const {
+            const Leaf* leaf = descend<true>(key);
+            return const_iterator(leaf, searchLeaf<true>(leaf, key), this);
+        }
+
+        template<typename Q>
+        std::pair<const_iterator, const_iterator> equal_range(const Q& key) const {
+            return {lower_bound(key), upper_bound(key)};
+        }
+
+        const_iterator begin() const { return const_iterator(head, 0, this); }
+        const_iterator end() const { return const_iterator(nullptr, 0, this); }
+
+
+        /*
+         * 用已按 key 升序且不重复的 [first, last) 替换树的内容, O(n):
+         * 叶子依次填满(最后几个平均分配以满足下限), 再自底向上逐层建立内部节点。
+         */
+        template<typename It>
+        void buildSorted(It first, It last) {
+            clear();
+            std::vector<T> items(first, last);
+            for (std::size_t i = 1; i < items.size(); ++i) {
+                assert(comp(keyOf(items[i - 1]), keyOf(items[i])) && "buildSorted: 输入必须严格升序");
+            }
+            if (items.empty()) return;
+
+            freeNode(root);
+            std::size_t leaves = (items.size() + LEAF_CAP - 1) / LEAF_CAP;
+            std::vector<std::pair<NodeHeader*, key_type>> level;
+            Leaf* prev = nullptr;
+            std::size_t pos = 0;
+            for (std::size_t n = 0; n < leaves; ++n) {
+                std::size_t take = items.size() / leaves + (n < items.size() % leaves ? 1 : 0);
+                Leaf* leaf = newLeaf();
+                std::move(items.begin() + pos, items.begin() + pos + take, leaf->items);
+                leaf->count = static_cast<std::uint32_t>(take);
+                leaf->prev = prev;
+                if (prev) prev->next = leaf;
+                else head = leaf;
+                prev = leaf;
+                pos += take;
+                level.emplace_back(leaf, keyOf(leaf->items[take - 1]));
+            }
+            tail = prev;
+
+            height = 1;
+            while (level.size() > 1) {
+                level = buildLevel(level);
+                ++height;
+            }
+            root = level.front().first;
+            count = items.size();
+        }
+
+
+        void clear() {
+            freeSubtree(root);
+            Leaf* leaf = newLeaf();
+            root = leaf;
+            head = tail = leaf;
+            count = 0;
+            height = 1;
+        }
+
+        std::size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        int depth() const { return height; }
+
+
+        // 第 k 小的元素(从0开始), k 超出范围时返回 nullptr; O(B log_B n)
+        const T* select(std::size_t k) const {
+            if (k >= count) return nullptr;
+            const NodeHeader* node = root;
+            while (!node->leaf) {
+                const Inner* inner = static_cast<const Inner*>(node);
+                std::size_t i = 0;
+                for (std::size_t size; k >= (size = subtreeSize(inner->children[i])); ++i) k -= size;
+                node = inner->children[i];
+            }
+            return &static_cast<const Leaf*>(node)->items[k];
+        }
+
+        // key 小于 key 的元素个数; O(B log_B n)
+        template<typename Q>
+        std::size_t rank(const Q& key) const {
+            std::size_t less = 0;
+            const NodeHeader* node = root;
+            while (!node->leaf) {
+                const Inner* inner = static_cast<const Inner*>(node);
+                // 子树 i 之前的孩子中所有 key 都不大于 sep[i - 1] < key
+                std::size_t i = searchInner<false>(inner, key);
+                for (std::size_t j = 0; j < i; ++j) less += subtreeSize(inner->children[j]);
+                node = inner->children[i];
+            }
+            return less + searchLeaf<false>(static_cast<const Leaf*>(node), key);
+        }
+
+        // 落在 [lo, hi) 内的元素个数; O(B log_B n)
+        template<typename Q1, typename Q2>
+        std::size_t countRange(const Q1& lo, const Q2& hi) const {
+            if (!comp(lo, hi)) return 0;
+            return rank(hi) - rank(lo);
+        }
+
+        // 打印所有元素(按 key 升序), 叶子之间用 | 分隔; 元素需要支持 operator<<
+        void print() const {
+            std::cout << "B+ 树(" << height << " 层, " << count << " 个元素): ";
+            for (const Leaf* leaf = head; leaf; leaf = leaf->next) {
+                if (leaf != head) std::cout << "| ";
+                for (std::size_t i = 0; i < leaf->count; ++i) std::cout << leaf->items[i] << " ";
+            }
+            std::cout << std::endl;
+        }
+
+        // 所有节点占用的字节数
+        std::size_t memoryUsage() const { return leaf_count * sizeof(Leaf) + inner_count * sizeof(Inner); }
+    };
+
+} // namespace btree
@@ -0,0 +1,121 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <vector>
+#include "./NodeSearch.h"
+
+
+namespace btree {
+    /*
+     * 只读的有序集合, 元素按 Eytzinger(BFS)顺序存放在一个数组中: 下标 k 的孩子是 2k 和 2k + 1(下标从 1 开始)。
+     * 与有序数组上的二分查找相比, 前几层的元素集中在数组开头, 总是留在缓存里;
+     * 下降时 k 的变化只取决于一次比较结果, 不需要分支, 并且可以提前预取若干层之后的候选位置:
+     * 第 k 个元素往下 L 层的 2^L 个后代在数组中是连续的, L 取使其大约占一条缓存行的层数。
+     * 适合构建一次、之后大量查找的数据; 修改需要重新构建。
+     */
+    template<typename T, typename Compare = std::less<>>
+    class EytzingerSet {
+    private:
+        std::vector<T> data;            // 下标从 1 开始, data[0] 占位
+        std::size_t count = 0;
+        [[no_unique_address]] Compare comp;
+
+        static constexpr std::size_t PREFETCH_LEVELS = 64 / sizeof(T) > 1 ? std::bit_width(64 / sizeof(T)) - 1 : 0;
+
+
+        // 中序遍历 Eytzinger 树的位置, 依次填入有序元素; O(n)
+        std::size_t fill(const std::vector<T>& sorted, std::size_t i, std::size_t k) {
+            if (k <= count) {
+                i = fill(sorted, i, 2 * k);
+                data[k] = sorted[i++];
+                i = fill(sorted, i, 2 * k + 1);
+            }
+            return i;
+        }
+
+
+        /*
+         * 返回第一个不小于 q 的元素的下标, 不存在时为 0。
+         * 下降结束时 k 的二进制表示记录了路径: 末尾的 1 表示向右, 去掉末尾连续的 1 以及其后的一个 0
+         * 就回到了最后一次向左拐的位置, 即答案。
+         */
+        template<typename Q>
+        std::size_t lowerBoundIndex(const Q& q) const {
+            std::size_t k = 1;
+            const T* base = data.data();
+            while (k <= count) {
+                if constexpr (PREFETCH_LEVELS > 0) prefetch(base + (k << PREFETCH_LEVELS));
+                k = 2 * k + static_cast<std::size_t>(comp(base[k], q));
+            }
+            k >>= std::countr_one(k) + 1;
+            return k;
+        }
+
+
+        template<typename F>
+        void visit(std::size_t k, F& callback) const {
+            if (k > count) return;
+            visit(2 * k, callback);
+            callback(data[k]);
+            visit(2 * k + 1, callback);
+        }
+
+
+    public:
+        EytzingerSet() : data(1) {}
+        explicit EytzingerSet(const Compare& c) : data(1), comp(c) {}
+
+        // 由任意顺序、可能重复的元素构建
+        template<typename It>
+        EytzingerSet(It first, It last, const Compare& c = Compare()) : comp(c) {
+            build(first, last);
+        }
+
+
+        template<typename It>
+        void build(It first, It last) {
+            std::vector<T> sorted(first, last);
+            std::sort(sorted.begin(), sorted.end(), comp);
+            sorted.erase(std::unique(sorted.begin(), sorted.end(),
+                                     [&](const T& a, const T& b) { return !comp(a, b) && !comp(b, a); }),
+                         sorted.end());
+            count = sorted.size();
+            data.assign(count + 1, T());
+            fill(sorted, 0, 1);
+        }
+
+
+        template<typename Q>
+        bool contains(const Q& q) const {
+            std::size_t k = lowerBoundIndex(q);
+            return k != 0 && !comp(q, data[k]);
+        }
+
+        // 第一个不小于 q 的元素, 不存在时返回 nullptr
+        template<typename Q>
+        const T* lower_bound(const Q& q) const {
+            std::size_t k = lowerBoundIndex(q);
+            return k != 0 ? &data[k] : nullptr;
+        }
+
+        template<typename Q>
+        const T* find(const Q& q) const {
+            std::size_t k = lowerBoundIndex(q);
+            return k != 0 && !comp(q, data[k]) ? &data[k] : nullptr;
+        }
+
+        // 按升序访问所有元素
+        template<typename F>
+        void forEach(F&& callback) const {
+            visit(1, callback);
+        }
+
+        std::size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        std::size_t memoryUsage() const { return data.capacity() * sizeof(T); }
+    };
+
+} // namespace btree
@@ -0,0 +1,104 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include "../RedBlackTree/KeyOf.h"
+
+
+namespace btree {
+    // 与 RedBlackTree 共用同一组 KeyOf, 见 RedBlackTree/KeyOf.h
+    using ::Identity;
+    using ::SelectFirst;
+
+
+    inline void prefetch(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(p, 0, 1);
+#else
+        (void)p;
+#endif
+    }
+
+
+    /*
+     * 节点内查找。宽节点里只有几十个 key, 对整数 key 顺序比较全部 key 并累加比较结果,
+     * 没有依赖比较结果的分支, 也就没有分支预测失败; 定义了 __AVX2__ 时(-mavx2 / -march=native)
+     * 一条指令比较 4 个 64 位或 8 个 32 位 key。其余类型的 key 使用二分查找。
+     */
+    template<typename K, typename Compare>
+    inline constexpr bool linear_search_v =
+        std::is_integral_v<K> && (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<K>>);
+
+
+#if defined(__AVX2__)
+    // 有符号比较指令处理无符号数: 两边都翻转最高位
+    template<bool OrEqual, typename K>
+    inline std::size_t countLessAvx2(const K* keys, std::size_t n, K q) {
+        std::size_t i = 0;
+        std::size_t count = 0;
+        if constexpr (sizeof(K) == 8) {
+            const long long bias = std::is_signed_v<K> ? 0 : static_cast<long long>(1ull << 63);
+            const __m256i flip = _mm256_set1_epi64x(bias);
+            const __m256i needle = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(q)), flip);
+            for (; i + 4 <= n; i += 4) {
+                __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), flip);
+                // OrEqual: 计数 !(v > q), 否则计数 q > v
+                __m256i m = OrEqual ? _mm256_cmpgt_epi64(v, needle) : _mm256_cmpgt_epi64(needle, v);
+                int bits = std::popcount(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(m))));
+                count += OrEqual ? 4 - bits : bits;
+            }
+        }
+        else if constexpr (sizeof(K) == 4) {
+            const int bias = std::is_signed_v<K> ? 0 : static_cast<int>(1u << 31);
+            const __m256i flip = _mm256_set1_epi32(bias);
+            const __m256i needle = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(q)), flip);
+            for (; i + 8 <= n; i += 8) {
+                __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), flip);
+                __m256i m = OrEqual ? _mm256_cmpgt_epi32(v, needle) : _mm256_cmpgt_epi32(needle, v);
+                int bits = std::popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(m))));
+                count += OrEqual ? 8 - bits : bits;
+            }
+        }
+        for (; i < n; ++i) count += OrEqual ? !(q < keys[i]) : keys[i] < q;
+        return count;
+    }
+#endif
+
+
+    /*
+     * keys[0, n) 升序, 返回小于 q 的 key 的个数(OrEqual 为 true 时返回不大于 q 的个数),
+     * 即 lower_bound(OrEqual 时为 upper_bound)的下标。proj 从数组元素中取出 key。
+     */
+    template<bool OrEqual, typename Item, typename Proj, typename Compare, typename Q>
+    inline std::size_t searchNode(const Item* items, std::size_t n, const Q& q, const Compare& comp, const Proj& proj) {
+        using K = std::remove_cvref_t<std::invoke_result_t<const Proj&, const Item&>>;
+        if constexpr (linear_search_v<K, Compare> && std::is_same_v<Q, K>) {
+#if defined(__AVX2__)
+            if constexpr (std::is_same_v<Item, K> && (sizeof(K) == 8 || sizeof(K) == 4)) {
+                return countLessAvx2<OrEqual>(items, n, q);
+            }
+#endif
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const K& k = proj(items[i]);
+                if constexpr (OrEqual) count += !(q < k);
+                else count += k < q;
+            }
+            return count;
+        }
+        else {
+            const Item* pos = std::partition_point(items, items + n, [&](const Item& item) {
+                if constexpr (OrEqual) return !comp(q, proj(item));
+                else return static_cast<bool>(comp(proj(item), q));
+            });
+            return static_cast<std::size_t>(pos - items);
+        }
+    }
+
+} // namespace btree
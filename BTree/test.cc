@@ -0,0 +1,51 @@
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BPlusTree.h"
+#include "EytzingerSet.h"
+
+// 测试示例
+int main() {
+    btree::BPlusTree<int> tree;
+
+    // 插入足够多的元素, 使树长出内部节点
+    for (int i = 0; i < 1000; ++i) tree.insert((i * 37) % 1000);
+    std::cout << "元素数: " << tree.size() << ", 层数: " << tree.depth() << ", 占用 " << tree.memoryUsage() << " 字节"
+              << std::endl;
+
+    // 删除所有奇数
+    for (int i = 1; i < 1000; i += 2) tree.remove(i);
+    std::cout << "删除奇数后: " << tree.size() << " 个, 包含 500: " << tree.contains(500)
+              << ", 包含 501: " << tree.contains(501) << std::endl;
+
+    // 范围遍历 [100, 120)
+    std::cout << "[100, 120): ";
+    for (auto it = tree.lower_bound(100); it != tree.end() && *it < 120; ++it) std::cout << *it << " ";
+    std::cout << std::endl;
+
+    // 顺序统计: 第 k 小的元素与小于某个 key 的元素个数
+    std::cout << "第 10 小: " << *tree.select(10) << ", 小于 300 的个数: " << tree.rank(300)
+              << ", [100, 200) 内: " << tree.countRange(100, 200) << ", 查找 7: " << (tree.search(7) ? "有" : "无")
+              << std::endl;
+
+    btree::BPlusTree<int, std::less<>, btree::Identity, 64> small;     // 小节点, 便于看出叶子的划分
+    for (int i = 0; i < 40; ++i) small.insert(i);
+    small.print();
+
+    // 映射用法: 按 first 排序
+    btree::BPlusTree<std::pair<std::string, int>, std::less<>, btree::SelectFirst> ages;
+    ages.insert({"bob", 31});
+    ages.insert({"alice", 28});
+    ages.insert({"carol", 45});
+    for (const auto& [name, age] : ages) std::cout << name << "=" << age << " ";
+    std::cout << std::endl;
+
+    // 只读集合: Eytzinger 布局
+    std::vector<int> primes{2, 3, 5, 7, 11, 13, 17, 19, 23, 29};
+    btree::EytzingerSet<int> set(primes.begin(), primes.end());
+    const int* next = set.lower_bound(20);
+    std::cout << "不小于 20 的第一个素数: " << (next ? *next : -1) << ", 包含 9: " << set.contains(9) << std::endl;
+
+    return 0;
+}
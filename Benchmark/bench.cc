@@ -0,0 +1,764 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <spanstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "./bench_harness.h"
+#include "../SkipList/src/skiplist.h"
+#include "../SkipList/src/lockfree_skiplist.h"
+#include "../SkipList/src/sharded_skiplist.h"
+#include "../RedBlackTree/RedBlackTree.h"
+#include "../RedBlackTree/ConcurrentRedBlackTree.h"
+#include "../BTree/BPlusTree.h"
+#include "../BTree/EytzingerSet.h"
+#include "../HuffmanTree/HuffmanTree.h"
+#include "../HuffmanTree/BlockCompressor.h"
+#include "../HuffmanTree/Histogram.h"
+
+
+/*
+ * 用法: bench [--suite=a,b] [--threads=1,2,4] [--dist=uniform,zipf,sequential] [--read=0.5,0.95]
+ *             [--ops=N] [--keys=N] [--shards=N] [--theta=0.99] [--dir=.] [--corpus=a,b] [--json=path|-]
+ *
+ * suite 可选: skiplist lockfree sharded wal snapshot rbtree rbtree-heap rbtree-locked rbtree-concurrent btree
+ *          eytzinger huffman huffman-decode huffman-file huffman-histogram huffman-symbols, 默认全部。
+ * 每组参数都会重新构建并预填充一半的 key, 读操作的命中率约为 50%。
+ */
+namespace {
+    using Key = std::uint64_t;
+    using Value = std::uint64_t;
+    constexpr int MAX_HEIGHT = 20;
+    constexpr std::uint64_t WAL_MAX_OPS = 20000;       // 每次写都要 fsync, 限制 wal 测试的规模
+    constexpr std::size_t HUFFMAN_BLOCK = 4096;         // huffman 每次操作编码并解码的字节数
+
+    struct Options {
+        std::vector<std::string> suites{"skiplist", "lockfree", "sharded", "wal", "snapshot", "rbtree", "rbtree-heap",
+                                         "rbtree-locked", "rbtree-concurrent", "btree", "eytzinger",
+                                         "huffman", "huffman-decode", "huffman-file",
+                                         "huffman-histogram", "huffman-symbols"};
+        std::vector<int> threads{1, 2, 4};
+        std::vector<bench::Distribution> dists{bench::Distribution::Uniform, bench::Distribution::Zipf,
+                                               bench::Distribution::Sequential};
+        std::vector<double> reads{0.5, 0.95};
+        std::uint64_t ops = 400000;
+        std::uint64_t keys = 1000000;
+        std::vector<std::size_t> shards{1, 2, 4, 8, 16};    // sharded 依次测试的分片数
+        double theta = 0.99;
+        std::string dir = ".";          // wal / snapshot 测试的临时文件目录
+        std::vector<std::string> corpus; // huffman-file 的输入文件, 为空时使用生成的文本
+        std::string json;               // 为空表示不输出 JSON, "-" 表示输出到标准输出
+    };
+
+
+    bool parseArgs(int argc, char const* argv[], Options& opt) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto eq = arg.find('=');
+            if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+                std::cerr << "unknown argument: " << arg << "\n";
+                return false;
+            }
+            std::string name = arg.substr(2, eq - 2);
+            std::string value = arg.substr(eq + 1);
+
+            if (name == "suite") {
+                opt.suites = bench::splitList(value);
+            }
+            else if (name == "threads") {
+                opt.threads.clear();
+                for (const auto& s : bench::splitList(value)) opt.threads.push_back(std::stoi(s));
+            }
+            else if (name == "dist") {
+                opt.dists.clear();
+                for (const auto& s : bench::splitList(value)) {
+                    bench::Distribution d;
+                    if (!bench::parseDistribution(s, d)) {
+                        std::cerr << "unknown distribution: " << s << "\n";
+                        return false;
+                    }
+                    opt.dists.push_back(d);
+                }
+            }
+            else if (name == "read") {
+                opt.reads.clear();
+                for (const auto& s : bench::splitList(value)) opt.reads.push_back(std::stod(s));
+            }
+            else if (name == "ops") opt.ops = std::stoull(value);
+            else if (name == "keys") opt.keys = std::stoull(value);
+            else if (name == "shards") {
+                opt.shards.clear();
+                for (const auto& s : bench::splitList(value)) opt.shards.push_back(std::stoull(s));
+            }
+            else if (name == "theta") opt.theta = std::stod(value);
+            else if (name == "dir") opt.dir = value;
+            else if (name == "corpus") opt.corpus = bench::splitList(value);
+            else if (name == "json") opt.json = value;
+            else {
+                std::cerr << "unknown option: --" << name << "\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    // 依次遍历 线程数 x 分布 x 读比例 的所有组合
+    template<typename F>
+    void forEachWorkload(const Options& opt, F&& f) {
+        for (int threads : opt.threads) {
+            for (bench::Distribution dist : opt.dists) {
+                for (double read : opt.reads) {
+                    bench::Workload w;
+                    w.threads = threads;
+                    w.dist = dist;
+                    w.read_ratio = read;
+                    w.ops = opt.ops;
+                    w.keys = opt.keys;
+                    w.zipf_theta = opt.theta;
+                    f(w);
+                }
+            }
+        }
+    }
+
+
+    // 预填充偶数 key
+    template<typename List>
+    void prefill(List& list, Key keys) {
+        for (Key k = 0; k < keys; k += 2) list.insertNode(k, k);
+    }
+
+
+    // 跳表类容器的混合负载: 读为 searchNode, 写为插入或删除各一半, 元素总数大致保持不变
+    template<typename List>
+    void mixedOp(List& list, bench::ThreadContext& ctx) {
+        Key key = ctx.keys.next();
+        if (ctx.nextIsRead()) {
+            bench::doNotOptimize(list.searchNode(key));
+        }
+        else if (ctx.keys.engine()() & 1) {
+            list.insertNode(key, key);
+        }
+        else {
+            list.deleteNode(key);
+        }
+    }
+
+
+    void benchSkipList(const Options& opt, bench::Report& report) {
+        forEachWorkload(opt, [&](const bench::Workload& w) {
+            skip_list::SkipList<Key, Value> list(MAX_HEIGHT);
+            prefill(list, w.keys);
+            auto r = bench::measure("skiplist", w, [&](bench::ThreadContext& ctx) { mixedOp(list, ctx); });
+            r.extra.emplace_back("contention", static_cast<double>(list.contention()));
+            r.extra.emplace_back("memory_bytes", static_cast<double>(list.memoryUsage()));
+            report.add(std::move(r));
+        });
+    }
+
+
+    void benchLockFree(const Options& opt, bench::Report& report) {
+        forEachWorkload(opt, [&](const bench::Workload& w) {
+            skip_list::LockFreeSkipList<Key, Value> list(MAX_HEIGHT);
+            prefill(list, w.keys);
+            report.add(bench::measure("lockfree", w, [&](bench::ThreadContext& ctx) { mixedOp(list, ctx); }));
+        });
+    }
+
+
+    /*
+     * 每个分片数各测一遍, 观察分片数对吞吐量和锁竞争的影响。
+     * contention 为各分片写锁需要等待的总次数, contention_i 为第 i 个分片的次数, 可以看出热点是否集中在少数分片。
+     */
+    void benchSharded(const Options& opt, bench::Report& report) {
+        for (std::size_t shards : opt.shards) {
+            forEachWorkload(opt, [&](const bench::Workload& w) {
+                skip_list::ShardedSkipList<Key, Value> list(MAX_HEIGHT, shards);
+                prefill(list, w.keys);
+                auto r = bench::measure("sharded", w, [&](bench::ThreadContext& ctx) { mixedOp(list, ctx); });
+
+                std::vector<std::uint64_t> per_shard = list.contention();
+                std::uint64_t contention = 0;
+                for (std::uint64_t c : per_shard) contention += c;
+                r.extra.emplace_back("shards", static_cast<double>(list.shardCount()));
+                r.extra.emplace_back("contention", static_cast<double>(contention));
+                for (std::size_t i = 0; i < per_shard.size(); ++i) {
+                    r.extra.emplace_back("contention_" + std::to_string(i), static_cast<double>(per_shard[i]));
+                }
+                report.add(std::move(r));
+            });
+        }
+    }
+
+
+    // 每次写操作都等待日志落盘, records_per_fsync 反映组提交的效果
+    void benchWal(const Options& opt, bench::Report& report) {
+        const std::string path = opt.dir + "/bench.wal";
+        forEachWorkload(opt, [&](bench::Workload w) {
+            if (w.ops > WAL_MAX_OPS) w.ops = WAL_MAX_OPS;
+            std::remove(path.c_str());
+            skip_list::SkipList<Key, Value> list(MAX_HEIGHT);
+            prefill(list, w.keys);
+            if (!list.openWal(path)) return;
+
+            auto r = bench::measure("skiplist-wal", w, [&](bench::ThreadContext& ctx) { mixedOp(list, ctx); });
+            auto* log = list.getWal();
+            r.extra.emplace_back("fsyncs", static_cast<double>(log->syncs()));
+            r.extra.emplace_back("records_per_fsync",
+                                 log->syncs() ? static_cast<double>(log->records()) / static_cast<double>(log->syncs()) : 0.0);
+            report.add(std::move(r));
+        });
+        std::remove(path.c_str());
+    }
+
+
+    // 测量期间在后台不断写快照, 观察前台延迟受到的影响
+    void benchSnapshot(const Options& opt, bench::Report& report) {
+        const std::string path = opt.dir + "/bench.snap";
+        forEachWorkload(opt, [&](const bench::Workload& w) {
+            skip_list::SkipList<Key, Value> list(MAX_HEIGHT);
+            prefill(list, w.keys);
+
+            std::atomic<bool> stop{false};
+            std::uint64_t snapshots = 0;
+            double duration = 0, max_stall = 0;
+            std::thread background([&] {
+                while (!stop.load()) {
+                    skip_list::SnapshotStats stats = list.dumpFileAsync(path).get();
+                    if (!stats.ok) break;
+                    ++snapshots;
+                    duration += stats.duration;
+                    if (stats.max_stall > max_stall) max_stall = stats.max_stall;
+                }
+            });
+
+            auto r = bench::measure("skiplist-snapshot", w, [&](bench::ThreadContext& ctx) { mixedOp(list, ctx); });
+            stop.store(true);
+            background.join();
+
+            r.extra.emplace_back("snapshots", static_cast<double>(snapshots));
+            r.extra.emplace_back("snapshot_mean_s", snapshots ? duration / static_cast<double>(snapshots) : 0.0);
+            r.extra.emplace_back("snapshot_max_stall_s", max_stall);
+            report.add(std::move(r));
+        });
+        std::remove(path.c_str());
+    }
+
+
+    /*
+     * RedBlackTree 不是线程安全的, 只测单线程。
+     * 写操作: 存在则删除, 不存在则插入; read=0 即为纯插入/删除的节点分配压力测试。
+     * Alloc 为节点分配器, rbtree-heap 使用逐个 new / delete 的 HeapAllocator 作对比。
+     */
+    template <template <typename> class Alloc>
+    void benchRedBlackTree(const Options& opt, bench::Report& report, const std::string& name) {
+        forEachWorkload(opt, [&](bench::Workload w) {
+            if (w.threads != 1) return;
+            auto tree = std::make_unique<RedBlackTree<Key, Alloc>>();
+            auto start = bench::Clock::now();
+            for (Key k = 0; k < w.keys; k += 2) tree->insert(k);
+            double build = std::chrono::duration<double>(bench::Clock::now() - start).count();
+
+            auto r = bench::measure(name, w, [&](bench::ThreadContext& ctx) {
+                Key key = ctx.keys.next();
+                if (ctx.nextIsRead()) {
+                    bench::doNotOptimize(tree->find(key) != tree->end());
+                }
+                else if (!tree->remove(key)) {
+                    tree->insert(key);
+                }
+            });
+
+            std::size_t memory = tree->memoryUsage();
+            start = bench::Clock::now();
+            tree.reset();
+            double teardown = std::chrono::duration<double>(bench::Clock::now() - start).count();
+
+            // 有序输入的批量构建, 以及合并一个 1/16 大小的增量(奇数 key)
+            std::vector<Key> sorted, delta;
+            for (Key k = 0; k < w.keys; k += 2) sorted.push_back(k);
+            for (Key k = 1; k < w.keys; k += 32) delta.push_back(k);
+            RedBlackTree<Key, Alloc> bulk, other;
+            start = bench::Clock::now();
+            bulk.buildSorted(sorted.begin(), sorted.end());
+            double bulk_build = std::chrono::duration<double>(bench::Clock::now() - start).count();
+            other.buildSorted(delta.begin(), delta.end());
+            start = bench::Clock::now();
+            bulk.unionWith(other);
+            double merge = std::chrono::duration<double>(bench::Clock::now() - start).count();
+
+            r.extra.emplace_back("build_s", build);
+            r.extra.emplace_back("memory_bytes", static_cast<double>(memory));
+            r.extra.emplace_back("bulk_build_s", bulk_build);
+            r.extra.emplace_back("union_s", merge);
+            r.extra.emplace_back("destroy_s", teardown);
+            report.add(std::move(r));
+        });
+    }
+
+
+    /*
+     * 多线程的红黑树, 读写操作与 rbtree 相同, 比较读操作随线程数的扩展:
+     * rbtree-locked 为外部加一把互斥锁的 RedBlackTree, 所有操作串行;
+     * rbtree-concurrent 为 ConcurrentRedBlackTree, 读操作乐观地不加锁。
+     */
+    void benchRedBlackTreeLocked(const Options& opt, bench::Report& report) {
+        forEachWorkload(opt, [&](const bench::Workload& w) {
+            RedBlackTree<Key> tree;
+            std::mutex mutex;
+            for (Key k = 0; k < w.keys; k += 2) tree.insert(k);
+
+            report.add(bench::measure("rbtree-locked", w, [&](bench::ThreadContext& ctx) {
+                Key key = ctx.keys.next();
+                bool read = ctx.nextIsRead();
+                std::lock_guard<std::mutex> lock(mutex);
+                if (read) {
+                    bench::doNotOptimize(tree.find(key) != tree.end());
+                }
+                else if (!tree.remove(key)) {
+                    tree.insert(key);
+                }
+            }));
+        });
+    }
+
+
+    void benchRedBlackTreeConcurrent(const Options& opt, bench::Report& report) {
+        forEachWorkload(opt, [&](const bench::Workload& w) {
+            ConcurrentRedBlackTree<Key> tree;
+            for (Key k = 0; k < w.keys; k += 2) tree.insert(k);
+
+            auto r = bench::measure("rbtree-concurrent", w, [&](bench::ThreadContext& ctx) {
+                Key key = ctx.keys.next();
+                if (ctx.nextIsRead()) {
+                    bench::doNotOptimize(tree.contains(key));
+                }
+                else if (!tree.erase(key)) {
+                    tree.insert(key);
+                }
+            });
+            r.extra.emplace_back("retries", static_cast<double>(tree.retries()));
+            r.extra.emplace_back("fallbacks", static_cast<double>(tree.fallbacks()));
+            report.add(std::move(r));
+        });
+    }
+
+
+    /*
+     * 宽节点的 B+ 树, 读写操作与 rbtree 相同, 只在 1 个线程时运行。
+     * 与 rbtree / skiplist 比较查找延迟时使用 --read=1 --threads=1。
+     */
+    void benchBTree(const Options& opt, bench::Report& report) {
+        forEachWorkload(opt, [&](const bench::Workload& w) {
+            if (w.threads != 1) return;
+            btree::BPlusTree<Key> tree;
+            auto start = bench::Clock::now();
+            for (Key k = 0; k < w.keys; k += 2) tree.insert(k);
+            double build = std::chrono::duration<double>(bench::Clock::now() - start).count();
+
+            auto r = bench::measure("btree", w, [&](bench::ThreadContext& ctx) {
+                Key key = ctx.keys.next();
+                if (ctx.nextIsRead()) {
+                    bench::doNotOptimize(tree.contains(key));
+                }
+                else if (!tree.remove(key)) {
+                    tree.insert(key);
+                }
+            });
+            r.extra.emplace_back("build_s", build);
+            r.extra.emplace_back("memory_bytes", static_cast<double>(tree.memoryUsage()));
+            r.extra.emplace_back("depth", static_cast<double>(tree.depth()));
+            report.add(std::move(r));
+        });
+    }
+
+
+    // 只读的 Eytzinger 布局集合, 构建后只有查找, 每个(线程数, 分布)只测一次
+    void benchEytzinger(const Options& opt, bench::Report& report) {
+        std::vector<Key> keys;
+        for (Key k = 0; k < opt.keys; k += 2) keys.push_back(k);
+        auto start = bench::Clock::now();
+        btree::EytzingerSet<Key> set(keys.begin(), keys.end());
+        double build = std::chrono::duration<double>(bench::Clock::now() - start).count();
+
+        for (int threads : opt.threads) {
+            for (bench::Distribution dist : opt.dists) {
+                bench::Workload w;
+                w.threads = threads;
+                w.dist = dist;
+                w.read_ratio = 1.0;
+                w.ops = opt.ops;
+                w.keys = opt.keys;
+                w.zipf_theta = opt.theta;
+
+                auto r = bench::measure("eytzinger", w, [&](bench::ThreadContext& ctx) {
+                    bench::doNotOptimize(set.contains(ctx.keys.next()));
+                });
+                r.extra.emplace_back("build_s", build);
+                r.extra.emplace_back("memory_bytes", static_cast<double>(set.memoryUsage()));
+                report.add(std::move(r));
+            }
+        }
+    }
+
+
+    /*
+     * HuffmanTree: 按给定分布生成 1MB 可打印字符文本, 建树不计入测量;
+     * 每次操作编码并解码一个 4KB 的块。编码表只读, 可以多线程同时使用。
+     * 读写比例对它没有意义, 每个(线程数, 分布)只测一次。
+     */
+    void benchHuffman(const Options& opt, bench::Report& report) {
+        constexpr std::size_t TEXT_SIZE = 1 << 20;
+        constexpr std::uint64_t ALPHABET = 95;
+
+        for (int threads : opt.threads) {
+            for (bench::Distribution dist : opt.dists) {
+                std::shared_ptr<const bench::ZipfParams> zipf;
+                if (dist == bench::Distribution::Zipf) zipf = std::make_shared<const bench::ZipfParams>(ALPHABET, opt.theta);
+                bench::KeyGenerator gen(dist, ALPHABET, 7, zipf);
+                std::string text(TEXT_SIZE, ' ');
+                for (char& c : text) c = static_cast<char>(' ' + gen.next());
+
+                HuffmanTree tree;
+                auto start = bench::Clock::now();
+                tree.buildTree(calculateFrequency(text));
+                double build = std::chrono::duration<double>(bench::Clock::now() - start).count();
+                std::size_t bits = tree.encode(text).size();
+                std::size_t compressed = tree.compress(text).size();
+
+                // 每块重建模型的开销: 由直方图建树 / 只生成范式码表, 各重复 1000 次取平均
+                constexpr int MODEL_REPEAT = 1000;
+                huffman::Histogram freqs = huffman::histogram({reinterpret_cast<const std::uint8_t*>(text.data()), text.size()});
+                HuffmanTree rebuilt;
+                start = bench::Clock::now();
+                for (int i = 0; i < MODEL_REPEAT; ++i) rebuilt.buildTree(freqs);
+                double tree_us = std::chrono::duration<double, std::micro>(bench::Clock::now() - start).count() / MODEL_REPEAT;
+                huffman::CodeTable model;
+                start = bench::Clock::now();
+                for (int i = 0; i < MODEL_REPEAT; ++i) model.build(freqs);
+                double table_us = std::chrono::duration<double, std::micro>(bench::Clock::now() - start).count() / MODEL_REPEAT;
+
+                bench::Workload w;
+                w.threads = threads;
+                w.dist = dist;
+                w.read_ratio = 1.0;
+                w.keys = ALPHABET;
+                w.ops = std::max<std::uint64_t>(64, opt.ops / 2000);
+                w.zipf_theta = opt.theta;
+
+                auto r = bench::measure("huffman", w, [&](bench::ThreadContext& ctx) {
+                    std::size_t block = ctx.keys.engine()() % (TEXT_SIZE / HUFFMAN_BLOCK);
+                    std::string encoded = tree.encode(text.substr(block * HUFFMAN_BLOCK, HUFFMAN_BLOCK));
+                    bench::doNotOptimize(tree.decode(encoded).size());
+                });
+                r.extra.emplace_back("build_s", build);
+                r.extra.emplace_back("bits_per_symbol", static_cast<double>(bits) / TEXT_SIZE);
+                r.extra.emplace_back("compressed_ratio", static_cast<double>(compressed) / TEXT_SIZE);
+                r.extra.emplace_back("tree_build_us", tree_us);
+                r.extra.emplace_back("table_build_us", table_us);
+                r.extra.emplace_back("mb_per_sec", static_cast<double>(r.latency.count() * HUFFMAN_BLOCK) / r.seconds / 1e6);
+                report.add(std::move(r));
+            }
+        }
+    }
+
+
+    /*
+     * 只测解码: 文本预先切成 4KB 的块并编码好, 每次操作解码一个块。
+     * huffman-tree 逐位遍历树解码 '0'/'1' 字符串, huffman-table 查表解码打包的比特流,
+     * huffman-table-x4 把块按 writeBlock 的交错格式分成 4 条比特流, 4 条同时解码。
+     */
+    void benchHuffmanDecode(const Options& opt, bench::Report& report) {
+        constexpr std::size_t TEXT_SIZE = 1 << 20;
+        constexpr std::size_t BLOCKS = TEXT_SIZE / HUFFMAN_BLOCK;
+        constexpr std::uint64_t ALPHABET = 95;
+
+        for (int threads : opt.threads) {
+            for (bench::Distribution dist : opt.dists) {
+                std::shared_ptr<const bench::ZipfParams> zipf;
+                if (dist == bench::Distribution::Zipf) zipf = std::make_shared<const bench::ZipfParams>(ALPHABET, opt.theta);
+                bench::KeyGenerator gen(dist, ALPHABET, 7, zipf);
+                std::string text(TEXT_SIZE, ' ');
+                for (char& c : text) c = static_cast<char>(' ' + gen.next());
+
+                HuffmanTree tree;
+                tree.buildTree(calculateFrequency(text));
+                huffman::CodeTable table(huffman::histogram({reinterpret_cast<const std::uint8_t*>(text.data()), text.size()}));
+                table.buildDecoder();
+                constexpr unsigned STREAMS = huffman::TableDecoder::STREAMS;
+                std::array<std::uint64_t, STREAMS> counts;
+                for (unsigned k = 0; k < STREAMS; ++k) counts[k] = huffman::detail::streamSymbols(HUFFMAN_BLOCK, k);
+                std::vector<std::string> strings;
+                std::vector<huffman::PackedBits> packed;
+                std::vector<std::array<huffman::PackedBits, STREAMS>> interleaved(BLOCKS);
+                for (std::size_t b = 0; b < BLOCKS; ++b) {
+                    std::string block = text.substr(b * HUFFMAN_BLOCK, HUFFMAN_BLOCK);
+                    strings.push_back(tree.encode(block));
+                    packed.push_back(tree.encodePacked(block));
+                    const auto* p = reinterpret_cast<const std::uint8_t*>(block.data());
+                    for (unsigned k = 0; k < STREAMS; ++k) {
+                        interleaved[b][k] = table.encode(p, counts[k]);
+                        p += counts[k];
+                    }
+                }
+
+                bench::Workload w;
+                w.threads = threads;
+                w.dist = dist;
+                w.read_ratio = 1.0;
+                w.keys = ALPHABET;
+                w.ops = std::max<std::uint64_t>(64, opt.ops / 100);
+                w.zipf_theta = opt.theta;
+
+                auto walk = bench::measure("huffman-tree", w, [&](bench::ThreadContext& ctx) {
+                    bench::doNotOptimize(tree.decode(strings[ctx.keys.engine()() % BLOCKS]).size());
+                });
+                auto single = bench::measure("huffman-table", w, [&](bench::ThreadContext& ctx) {
+                    bench::doNotOptimize(tree.decodePacked(packed[ctx.keys.engine()() % BLOCKS]).size());
+                });
+                auto multi = bench::measure("huffman-table-x4", w, [&](bench::ThreadContext& ctx) {
+                    const auto& streams = interleaved[ctx.keys.engine()() % BLOCKS];
+                    std::array<huffman::BitReader, STREAMS> readers{
+                        huffman::BitReader(streams[0].bytes.data(), streams[0].bytes.size()),
+                        huffman::BitReader(streams[1].bytes.data(), streams[1].bytes.size()),
+                        huffman::BitReader(streams[2].bytes.data(), streams[2].bytes.size()),
+                        huffman::BitReader(streams[3].bytes.data(), streams[3].bytes.size()),
+                    };
+                    std::string decoded(HUFFMAN_BLOCK, '\0');
+                    std::array<char*, STREAMS> out{decoded.data(), decoded.data() + counts[0], decoded.data() + counts[0] + counts[1],
+                                                   decoded.data() + counts[0] + counts[1] + counts[2]};
+                    std::array<std::uint64_t, STREAMS> consumed{};
+                    table.decodeInterleaved(readers, out, counts, consumed);
+                    bench::doNotOptimize(decoded.size());
+                });
+                for (auto* r : {&walk, &single, &multi}) {
+                    r->extra.emplace_back("mb_per_sec", static_cast<double>(r->latency.count() * HUFFMAN_BLOCK) / r->seconds / 1e6);
+                }
+                single.extra.emplace_back("speedup", walk.seconds / single.seconds);
+                multi.extra.emplace_back("speedup", walk.seconds / multi.seconds);
+                report.add(std::move(walk));
+                report.add(std::move(single));
+                report.add(std::move(multi));
+            }
+        }
+    }
+
+
+    // 分块压缩 / 解压整个语料一次, 块在线程池中并行处理; 测量期间只有一个调用线程
+    void benchHuffmanCorpus(const Options& opt, bench::Report& report, const std::string& label,
+                            bench::Distribution dist, const std::string& corpus) {
+        std::vector<char> compressed(corpus.size() + corpus.size() / 64 + 4096);
+        std::vector<char> restored(corpus.size());
+        std::size_t compressed_size = 0;
+
+        for (int threads : opt.threads) {
+            huffman::BlockOptions options;
+            options.threads = static_cast<std::size_t>(threads);
+
+            bench::Workload w;
+            w.threads = 1;
+            w.dist = dist;
+            w.read_ratio = 1.0;
+            w.keys = corpus.size();
+            w.ops = std::max<std::uint64_t>(3, (std::uint64_t{64} << 20) / std::max<std::size_t>(corpus.size(), 1));
+
+            auto compress = bench::measure("huffman-compress" + label, w, [&](bench::ThreadContext&) {
+                std::ispanstream in(std::span<const char>(corpus.data(), corpus.size()));
+                std::ospanstream out(std::span<char>(compressed.data(), compressed.size()));
+                huffman::compressStream(in, out, options);
+                compressed_size = out.span().size();
+            });
+            auto decompress = bench::measure("huffman-decompress" + label, w, [&](bench::ThreadContext&) {
+                std::ispanstream in(std::span<const char>(compressed.data(), compressed_size));
+                std::ospanstream out(std::span<char>(restored.data(), restored.size()));
+                huffman::decompressStream(in, out, options.threads);
+            });
+            if (!std::equal(restored.begin(), restored.end(), corpus.begin())) std::cerr << "huffman-file: round trip mismatch\n";
+
+            for (auto* r : {&compress, &decompress}) {
+                r->workload.threads = threads;
+                r->extra.emplace_back("ratio", static_cast<double>(compressed_size) / static_cast<double>(corpus.size()));
+                r->extra.emplace_back("mb_per_sec", static_cast<double>(r->latency.count() * corpus.size()) / r->seconds / 1e6);
+            }
+            report.add(std::move(compress));
+            report.add(std::move(decompress));
+        }
+    }
+
+
+    /*
+     * 文件级分块压缩: 默认按给定分布生成 16MB 的可打印字符文本, --corpus 指定文件时改用文件内容。
+     * 线程数是线程池的大小, 报告压缩比 ratio 与吞吐 mb_per_sec。
+     */
+    void benchHuffmanFile(const Options& opt, bench::Report& report) {
+        if (!opt.corpus.empty()) {
+            for (const auto& path : opt.corpus) {
+                std::ifstream file(path, std::ios::binary);
+                if (!file) {
+                    std::cerr << "cannot read corpus " << path << "\n";
+                    continue;
+                }
+                std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                std::string label = "[" + path.substr(path.find_last_of("/\\") + 1) + "]";
+                benchHuffmanCorpus(opt, report, label, bench::Distribution::Uniform, data);
+            }
+            return;
+        }
+
+        constexpr std::size_t TEXT_SIZE = 16 << 20;
+        constexpr std::uint64_t ALPHABET = 95;
+        for (bench::Distribution dist : opt.dists) {
+            std::shared_ptr<const bench::ZipfParams> zipf;
+            if (dist == bench::Distribution::Zipf) zipf = std::make_shared<const bench::ZipfParams>(ALPHABET, opt.theta);
+            bench::KeyGenerator gen(dist, ALPHABET, 7, zipf);
+            std::string text(TEXT_SIZE, ' ');
+            for (char& c : text) c = static_cast<char>(' ' + gen.next());
+            benchHuffmanCorpus(opt, report, "", dist, text);
+        }
+    }
+
+
+    /*
+     * 频率统计: histogram-map 是逐字节哈希的 calculateFrequency, histogram 是交错子直方图的数组计数,
+     * 线程数为 huffman::histogram 切分的段数。每次操作统计 64MB 文本, 报告 mb_per_sec。
+     */
+    void benchHistogram(const Options& opt, bench::Report& report) {
+        constexpr std::size_t TEXT_SIZE = 64 << 20;
+        constexpr std::uint64_t ALPHABET = 95;
+        for (bench::Distribution dist : opt.dists) {
+            std::shared_ptr<const bench::ZipfParams> zipf;
+            if (dist == bench::Distribution::Zipf) zipf = std::make_shared<const bench::ZipfParams>(ALPHABET, opt.theta);
+            bench::KeyGenerator gen(dist, ALPHABET, 7, zipf);
+            std::string text(TEXT_SIZE, ' ');
+            for (char& c : text) c = static_cast<char>(' ' + gen.next());
+            std::span<const std::uint8_t> bytes(reinterpret_cast<const std::uint8_t*>(text.data()), text.size());
+
+            bench::Workload w;
+            w.threads = 1;
+            w.dist = dist;
+            w.read_ratio = 1.0;
+            w.keys = ALPHABET;
+            w.ops = 4;
+
+            auto addThroughput = [&](bench::Result& r) {
+                r.extra.emplace_back("mb_per_sec", static_cast<double>(r.latency.count() * TEXT_SIZE) / r.seconds / 1e6);
+                report.add(std::move(r));
+            };
+            auto map = bench::measure("histogram-map", w, [&](bench::ThreadContext&) {
+                bench::doNotOptimize(calculateFrequency(text).size());
+            });
+            addThroughput(map);
+            for (int threads : opt.threads) {
+                auto r = bench::measure("histogram", w, [&](bench::ThreadContext&) {
+                    bench::doNotOptimize(huffman::histogram(bytes, static_cast<std::size_t>(threads))[' ']);
+                });
+                r.workload.threads = threads;
+                addThroughput(r);
+            }
+        }
+    }
+
+
+    // 统计频率、建码表并写出一个块 / 读回这个块, 报告压缩比与按原始字节计的吞吐
+    template<typename Symbol>
+    void benchSymbolBlock(bench::Report& report, const bench::Workload& w, const std::string& name, const std::vector<Symbol>& data,
+                          std::size_t plainBytes) {
+        std::vector<std::uint8_t> block;
+        auto compress = bench::measure(name + "-compress", w, [&](bench::ThreadContext&) {
+            block.clear();
+            huffman::BasicCodeTable<Symbol> table;
+            if constexpr (sizeof(Symbol) == 1) table.build(huffman::histogram(data));
+            else table.build(huffman::symbolHistogram<Symbol>(data));
+            huffman::writeBlock(table, data, block);
+        });
+        std::vector<Symbol> restored;
+        auto decompress = bench::measure(name + "-decompress", w, [&](bench::ThreadContext&) {
+            restored.clear();
+            huffman::readBlock(block, restored);
+        });
+        if (restored != data) std::cerr << "huffman-symbols: round trip mismatch\n";
+        for (auto* r : {&compress, &decompress}) {
+            r->extra.emplace_back("ratio", static_cast<double>(block.size()) / static_cast<double>(plainBytes));
+            r->extra.emplace_back("mb_per_sec", static_cast<double>(r->latency.count() * plainBytes) / r->seconds / 1e6);
+        }
+        report.add(std::move(compress));
+        report.add(std::move(decompress));
+    }
+
+
+    /*
+     * 多字节符号: 按给定分布生成 2M 个取值 0..32767 的 16 位词元。symbols-byte 把它们当作字节流压缩,
+     * symbols-u16 以词元为符号(稠密码表), symbols-u32 把词元乘一个大奇数散布到 32 位(稀疏码表)。
+     */
+    void benchSymbols(const Options& opt, bench::Report& report) {
+        constexpr std::size_t TOKENS = 2 << 20;
+        constexpr std::uint64_t VOCABULARY = 32768;
+        for (bench::Distribution dist : opt.dists) {
+            std::shared_ptr<const bench::ZipfParams> zipf;
+            if (dist == bench::Distribution::Zipf) zipf = std::make_shared<const bench::ZipfParams>(VOCABULARY, opt.theta);
+            bench::KeyGenerator gen(dist, VOCABULARY, 7, zipf);
+            std::vector<std::uint16_t> tokens(TOKENS);
+            for (auto& t : tokens) t = static_cast<std::uint16_t>(gen.next());
+            std::vector<std::uint32_t> wide(tokens.begin(), tokens.end());
+            for (auto& t : wide) t *= 2654435761u;
+            const auto* raw = reinterpret_cast<const std::uint8_t*>(tokens.data());
+            std::vector<std::uint8_t> bytes(raw, raw + TOKENS * sizeof(std::uint16_t));
+
+            bench::Workload w;
+            w.threads = 1;
+            w.dist = dist;
+            w.read_ratio = 1.0;
+            w.keys = VOCABULARY;
+            w.ops = 4;
+            benchSymbolBlock(report, w, "symbols-byte", bytes, bytes.size());
+            benchSymbolBlock(report, w, "symbols-u16", tokens, bytes.size());
+            benchSymbolBlock(report, w, "symbols-u32", wide, bytes.size());
+        }
+    }
+}
+
+
+int main(int argc, char const* argv[]) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) return 1;
+
+    bench::Report report;
+    for (const auto& suite : opt.suites) {
+        if (suite == "skiplist") benchSkipList(opt, report);
+        else if (suite == "lockfree") benchLockFree(opt, report);
+        else if (suite == "sharded") benchSharded(opt, report);
+        else if (suite == "wal") benchWal(opt, report);
+        else if (suite == "snapshot") benchSnapshot(opt, report);
+        else if (suite == "rbtree") benchRedBlackTree<NodePool>(opt, report, "rbtree");
+        else if (suite == "rbtree-heap") benchRedBlackTree<HeapAllocator>(opt, report, "rbtree-heap");
+        else if (suite == "rbtree-locked") benchRedBlackTreeLocked(opt, report);
+        else if (suite == "rbtree-concurrent") benchRedBlackTreeConcurrent(opt, report);
+        else if (suite == "btree") benchBTree(opt, report);
+        else if (suite == "eytzinger") benchEytzinger(opt, report);
+        else if (suite == "huffman") benchHuffman(opt, report);
+        else if (suite == "huffman-decode") benchHuffmanDecode(opt, report);
+        else if (suite == "huffman-file") benchHuffmanFile(opt, report);
+        else if (suite == "huffman-histogram") benchHistogram(opt, report);
+        else if (suite == "huffman-symbols") benchSymbols(opt, report);
+        else std::cerr << "unknown suite: " << suite << "\n";
+    }
+
+    if (opt.json == "-") {
+        report.writeJson(std::cout);
+    }
+    else if (!opt.json.empty()) {
+        std::ofstream out(opt.json);
+        if (!out) {
+            std::cerr << "cannot write " << opt.json << "\n";
+            return 1;
+        }
+        report.writeJson(out);
+    }
+    return 0;
+}
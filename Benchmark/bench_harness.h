@@ -0,0 +1,394 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <latch>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+/*
+ * 仓库内置的基准测试框架, 不依赖第三方库:
+ * 1. Histogram    对数-线性分桶的延迟直方图, 给出 p50/p99/p999
+ * 2. KeyGenerator 均匀、Zipf、顺序三种 key 分布
+ * 3. measure      多线程同时开跑, 逐次计时, 汇总吞吐量与延迟
+ * 4. Report       文本输出与 JSON 输出, 便于比较不同构建之间的回归
+ */
+namespace bench {
+    using Clock = std::chrono::steady_clock;
+
+
+    /*
+     * 延迟直方图(单位纳秒)。
+     * 小于 SUB_BUCKETS 的值各占一个桶; 之后每个 [2^k, 2^(k+1)) 区间均分为 SUB_BUCKETS 个桶,
+     * 相对误差不超过 1 / SUB_BUCKETS, 占用固定 15KB, 记录一次只是一次加法。
+     */
+    class Histogram {
+    private:
+        static constexpr int SUB_BITS = 5;
+        static constexpr std::uint64_t SUB_BUCKETS = 1ull << SUB_BITS;
+        static constexpr std::size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+        std::array<std::uint64_t, BUCKETS> buckets{};
+        std::uint64_t total = 0;
+        std::uint64_t sum = 0;
+        std::uint64_t min_value = UINT64_MAX;
+        std::uint64_t max_value = 0;
+
+
+        static std::size_t indexOf(std::uint64_t v) {
+            if (v < SUB_BUCKETS) return static_cast<std::size_t>(v);
+            int shift = (63 - std::countl_zero(v)) - SUB_BITS;
+            return static_cast<std::size_t>((shift + 1) * SUB_BUCKETS + ((v >> shift) - SUB_BUCKETS));
+        }
+
+        // 桶内最大的值, 报告分位数时取上界, 宁可高估延迟
+        static std::uint64_t upperOf(std::size_t idx) {
+            if (idx < SUB_BUCKETS) return idx;
+            int shift = static_cast<int>(idx / SUB_BUCKETS) - 1;
+            std::uint64_t lower = (SUB_BUCKETS + idx % SUB_BUCKETS) << shift;
+            return lower + ((1ull << shift) - 1);
+        }
+
+
+    public:
+        void record(std::uint64_t ns) {
+            ++buckets[indexOf(ns)];
+            ++total;
+            sum += ns;
+            if (ns < min_value) min_value = ns;
+            if (ns > max_value) max_value = ns;
+        }
+
+        void merge(const Histogram& other) {
+            for (std::size_t i = 0; i < BUCKETS; ++i) buckets[i] += other.buckets[i];
+            total += other.total;
+            sum += other.sum;
+            min_value = std::min(min_value, other.min_value);
+            max_value = std::max(max_value, other.max_value);
+        }
+
+        // p 取值 [0, 100]
+        std::uint64_t percentile(double p) const {
+            if (total == 0) return 0;
+            auto rank = static_cast<std::uint64_t>(std::ceil(p / 100.0 * static_cast<double>(total)));
+            if (rank == 0) rank = 1;
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < BUCKETS; ++i) {
+                seen += buckets[i];
+                if (seen >= rank) return std::min(upperOf(i), max_value);
+            }
+            return max_value;
+        }
+
+        std::uint64_t count() const { return total; }
+        std::uint64_t min() const { return total ? min_value : 0; }
+        std::uint64_t max() const { return max_value; }
+        double mean() const { return total ? static_cast<double>(sum) / static_cast<double>(total) : 0.0; }
+    };
+
+
+    enum class Distribution { Uniform, Zipf, Sequential };
+
+    inline const char* toString(Distribution d) {
+        switch (d) {
+            case Distribution::Uniform: return "uniform";
+            case Distribution::Zipf: return "zipf";
+            case Distribution::Sequential: return "sequential";
+        }
+        return "unknown";
+    }
+
+    inline bool parseDistribution(const std::string& s, Distribution& d) {
+        if (s == "uniform") d = Distribution::Uniform;
+        else if (s == "zipf") d = Distribution::Zipf;
+        else if (s == "sequential") d = Distribution::Sequential;
+        else return false;
+        return true;
+    }
+
+
+    /*
+     * Zipf 分布的常量, 只与 key 空间大小和 theta 有关, 各线程共享。
+     * 采用 Gray 等人的方法(YCSB 同款): 预先计算 zeta(n), 之后每次采样 O(1)。
+     */
+    struct ZipfParams {
+        std::uint64_t n;
+        double theta, alpha, zetan, eta;
+
+        ZipfParams(std::uint64_t items, double t) : n(items), theta(t) {
+            zetan = 0;
+            for (std::uint64_t i = 1; i <= n; ++i) zetan += 1.0 / std::pow(static_cast<double>(i), theta);
+            double zeta2 = 1.0 + 1.0 / std::pow(2.0, theta);
+            alpha = 1.0 / (1.0 - theta);
+            eta = (1.0 - std::pow(2.0 / static_cast<double>(n), 1.0 - theta)) / (1.0 - zeta2 / zetan);
+        }
+    };
+
+
+    /*
+     * key 生成器, 每个线程一个, 取值范围 [0, n):
+     * Uniform    均匀分布
+     * Zipf       排名越靠前越热, 再用乘法哈希把热点打散到整个 key 空间
+     * Sequential 线程 tid 依次生成 tid, tid + stride, tid + 2 * stride ... (取模 n)
+     */
+    class KeyGenerator {
+    private:
+        Distribution dist;
+        std::uint64_t n;
+        std::mt19937_64 rng;
+        std::shared_ptr<const ZipfParams> zipf;
+        std::uint64_t next_seq;
+        std::uint64_t stride;
+
+        double uniform01() { return std::uniform_real_distribution<double>(0.0, 1.0)(rng); }
+
+    public:
+        KeyGenerator(Distribution d, std::uint64_t items, std::uint64_t seed,
+                     std::shared_ptr<const ZipfParams> z = nullptr, std::uint64_t start = 0, std::uint64_t step = 1)
+            : dist(d), n(items ? items : 1), rng(seed), zipf(std::move(z)), next_seq(start), stride(step) {}
+
+        std::uint64_t next() {
+            switch (dist) {
+                case Distribution::Uniform:
+                    return rng() % n;
+                case Distribution::Sequential: {
+                    std::uint64_t k = next_seq % n;
+                    next_seq += stride;
+                    return k;
+                }
+                case Distribution::Zipf: {
+                    double u = uniform01();
+                    double uz = u * zipf->zetan;
+                    std::uint64_t rank;
+                    if (uz < 1.0) rank = 0;
+                    else if (uz < 1.0 + std::pow(0.5, zipf->theta)) rank = 1;
+                    else rank = static_cast<std::uint64_t>(static_cast<double>(n) * std::pow(zipf->eta * u - zipf->eta + 1.0, zipf->alpha));
+                    if (rank >= n) rank = n - 1;
+                    return (rank * 0x9E3779B97F4A7C15ull) % n;
+                }
+            }
+            return 0;
+        }
+
+        std::mt19937_64& engine() { return rng; }
+    };
+
+
+    // 阻止编译器把基准测试中的计算结果当作无用代码删除
+    template<typename T>
+    inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+
+    // 一组测试的参数
+    struct Workload {
+        int threads = 1;
+        Distribution dist = Distribution::Uniform;
+        double read_ratio = 0.9;            // 读操作占比
+        std::uint64_t ops = 1000000;        // 所有线程合计的操作次数
+        std::uint64_t keys = 1000000;       // key 空间大小
+        double zipf_theta = 0.99;
+        std::uint64_t seed = 42;
+    };
+
+
+    // 线程私有的上下文, 由 measure 传给每次操作
+    struct ThreadContext {
+        int tid;
+        KeyGenerator keys;
+        std::uint64_t read_threshold;       // rng() < read_threshold 时执行读操作
+
+        bool nextIsRead() { return keys.engine()() < read_threshold; }
+    };
+
+
+    struct Result {
+        std::string name;
+        Workload workload;
+        double seconds = 0;
+        Histogram latency;
+        std::vector<std::pair<std::string, double>> extra;     // 各测试特有的指标
+
+        double opsPerSec() const { return seconds > 0 ? static_cast<double>(latency.count()) / seconds : 0.0; }
+    };
+
+
+    /*
+     * 以 w.threads 个线程执行 op(ctx), 合计 w.ops 次。
+     * 所有线程在 latch 上同时起跑, 每次调用单独计时(计时本身约几十纳秒);
+     * 测量期间不做任何输出。
+     */
+    template<typename Op>
+    Result measure(const std::string& name, const Workload& w, Op&& op) {
+        int threads = w.threads > 0 ? w.threads : 1;
+        std::shared_ptr<const ZipfParams> zipf;
+        if (w.dist == Distribution::Zipf) zipf = std::make_shared<const ZipfParams>(w.keys, w.zipf_theta);
+
+        auto threshold = static_cast<std::uint64_t>(std::clamp(w.read_ratio, 0.0, 1.0) * 18446744073709551615.0);
+        if (w.read_ratio >= 1.0) threshold = UINT64_MAX;
+
+        std::vector<Histogram> histograms(threads);
+        std::latch ready(threads + 1);
+        std::latch go(1);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::uint64_t count = w.ops / threads + (static_cast<std::uint64_t>(t) < w.ops % threads ? 1 : 0);
+                ThreadContext ctx{t, KeyGenerator(w.dist, w.keys, w.seed * 1000003 + t, zipf,
+                                                  static_cast<std::uint64_t>(t), static_cast<std::uint64_t>(threads)),
+                                  threshold};
+                Histogram& hist = histograms[t];
+                ready.count_down();
+                go.wait();
+                for (std::uint64_t i = 0; i < count; ++i) {
+                    auto start = Clock::now();
+                    op(ctx);
+                    auto finish = Clock::now();
+                    hist.record(static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count()));
+                }
+            });
+        }
+
+        ready.arrive_and_wait();
+        auto start = Clock::now();
+        go.count_down();
+        for (auto& worker : workers) worker.join();
+        auto finish = Clock::now();
+
+        Result result;
+        result.name = name;
+        result.workload = w;
+        result.workload.threads = threads;
+        result.seconds = std::chrono::duration<double>(finish - start).count();
+        for (const auto& h : histograms) result.latency.merge(h);
+        return result;
+    }
+
+
+    // 汇总所有结果, 打印文本表格并可选地写出 JSON
+    class Report {
+    private:
+        std::vector<Result> results;
+
+        static std::string escape(const std::string& s) {
+            std::string out;
+            for (char c : s) {
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                    out += c;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                }
+                else {
+                    out += c;
+                }
+            }
+            return out;
+        }
+
+    public:
+        void add(Result r) {
+            print(std::cout, r);
+            results.push_back(std::move(r));
+        }
+
+        static void print(std::ostream& os, const Result& r) {
+            os << std::left << std::setw(20) << r.name << std::right
+               << " threads=" << std::setw(2) << r.workload.threads
+               << " dist=" << std::setw(10) << toString(r.workload.dist)
+               << " read=" << std::fixed << std::setprecision(2) << r.workload.read_ratio
+               << " ops/s=" << std::setw(12) << std::setprecision(0) << r.opsPerSec()
+               << " p50=" << r.latency.percentile(50) << "ns"
+               << " p99=" << r.latency.percentile(99) << "ns"
+               << " p999=" << r.latency.percentile(99.9) << "ns";
+            os.unsetf(std::ios::floatfield);
+            os << std::setprecision(6);
+            for (const auto& [key, value] : r.extra) os << " " << key << "=" << value;
+            os << "\n";
+        }
+
+        void writeJson(std::ostream& os) const {
+            std::time_t now = std::time(nullptr);
+            char date[32];
+            std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+            os << "{\n  \"context\": {\n"
+               << "    \"date\": \"" << date << "\",\n"
+               << "    \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef __VERSION__
+               << "    \"compiler\": \"" << escape(__VERSION__) << "\",\n"
+#endif
+#ifdef NDEBUG
+               << "    \"ndebug\": true\n"
+#else
+               << "    \"ndebug\": false\n"
+#endif
+               << "  },\n  \"benchmarks\": [";
+
+            for (std::size_t i = 0; i < results.size(); ++i) {
+                const Result& r = results[i];
+                os << (i ? ",\n" : "\n") << "    {"
+                   << "\"name\": \"" << escape(r.name) << "\", "
+                   << "\"threads\": " << r.workload.threads << ", "
+                   << "\"distribution\": \"" << toString(r.workload.dist) << "\", "
+                   << "\"read_ratio\": " << r.workload.read_ratio << ", "
+                   << "\"keys\": " << r.workload.keys << ", "
+                   << "\"ops\": " << r.latency.count() << ", "
+                   << "\"seconds\": " << r.seconds << ", "
+                   << "\"ops_per_sec\": " << r.opsPerSec() << ", "
+                   << "\"latency_ns\": {"
+                   << "\"min\": " << r.latency.min() << ", "
+                   << "\"mean\": " << r.latency.mean() << ", "
+                   << "\"p50\": " << r.latency.percentile(50) << ", "
+                   << "\"p99\": " << r.latency.percentile(99) << ", "
+                   << "\"p999\": " << r.latency.percentile(99.9) << ", "
+                   << "\"max\": " << r.latency.max() << "}";
+                for (const auto& [key, value] : r.extra) os << ", \"" << escape(key) << "\": " << value;
+                os << "}";
+            }
+            os << "\n  ]\n}\n";
+        }
+
+        const std::vector<Result>& all() const { return results; }
+    };
+
+
+    // 解析 "1,2,4" 形式的逗号分隔列表
+    inline std::vector<std::string> splitList(const std::string& s) {
+        std::vector<std::string> out;
+        std::stringstream ss(s);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) out.push_back(item);
+        }
+        return out;
+    }
+
+} // namespace bench
@@ -0,0 +1,239 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "./CodeTable.h"
+#include "./Histogram.h"
+
+
+namespace huffman {
+    /*
+     * 自适应模式: 不需要预先知道频率, 数据到达时立即编码。编码端和解码端各自维护一份相同的计数,
+     * 所有字节的计数从 1 开始, 因此任何字节随时都有码字, 不需要转义符号。
+     * 每编码 interval 个字节按当前计数重建一次码表, interval 从 MIN_INTERVAL 开始翻倍到 max_interval,
+     * 开头几百个字节就能适应数据; 计数总和超过 decay_threshold 时全部减半, 模型跟随数据分布的变化。
+     * 两端在同样的位置、用同样的计数重建, 码表始终一致, 流中不需要携带码表。
+     *
+     * 每个字节的代价是一次查表编码, 加上均摊的重建开销(256 个符号的建表, 几微秒);
+     * 内存只有计数、码表和一个数据块的输出缓冲区, 与流的长度无关。
+     *
+     * 流格式:
+     *   [魔数 "HUFA"][版本号 1 字节][max_interval varint][decay_threshold varint][max_chunk varint]
+     *   之后是若干数据块: [字节数 varint][有效比特数 varint][比特流, 补齐到整字节]
+     * 块只是传输单位, 模型跨块延续; 调用者每次 flush 产生一个块, 未 flush 的字节达到 max_chunk 时自动成块。
+     */
+    inline constexpr std::array<std::uint8_t, 4> ADAPTIVE_MAGIC{'H', 'U', 'F', 'A'};
+    inline constexpr std::uint8_t ADAPTIVE_VERSION = 1;
+    inline constexpr std::uint64_t ADAPTIVE_MAX_CHUNK = 64 << 20;    // 防止损坏的头部导致过大的缓冲
+
+    struct AdaptiveOptions {
+        std::uint64_t max_interval = 8192;          // 两次重建之间的最大字节数
+        std::uint64_t decay_threshold = 1 << 16;    // 计数总和超过它时减半
+        std::uint64_t max_chunk = 64 << 10;         // 一个数据块最多的字节数
+    };
+
+
+    // 编码端与解码端共享的模型
+    class AdaptiveModel {
+    private:
+        static constexpr std::uint64_t MIN_INTERVAL = 256;
+
+        Histogram counts;
+        std::uint64_t total = ALPHABET_SIZE;
+        std::uint64_t interval = MIN_INTERVAL;
+        std::uint64_t until_rebuild = MIN_INTERVAL;
+        AdaptiveOptions options;
+        CodeTable table;
+        bool decoding;
+
+        void rebuild() {
+            if (total > options.decay_threshold) {
+                total = 0;
+                for (auto& c : counts) {
+                    c = (c + 1) / 2;
+                    total += c;
+                }
+            }
+            table.build(counts);
+            if (decoding) table.buildDecoder();
+            interval = std::min(interval * 2, options.max_interval);
+            until_rebuild = interval;
+        }
+
+    public:
+        AdaptiveModel(const AdaptiveOptions& o, bool forDecoding) : options(o), decoding(forDecoding) {
+            if (options.max_interval < MIN_INTERVAL) throw std::invalid_argument("huffman: adaptive interval too small");
+            if (options.max_chunk == 0 || options.max_chunk > ADAPTIVE_MAX_CHUNK) {
+                throw std::invalid_argument("huffman: adaptive chunk size out of range");
+            }
+            counts.fill(1);
+            table.build(counts);
+            if (decoding) table.buildDecoder();
+        }
+
+        const CodeTable& codeTable() const { return table; }
+
+        // 当前码表还能用于多少个字节
+        std::uint64_t remaining() const { return until_rebuild; }
+
+        // 已经用当前码表处理了 data, 更新计数, 到期时重建
+        void update(std::span<const std::uint8_t> data) {
+            countBytes(data, counts);
+            total += data.size();
+            until_rebuild -= data.size();
+            if (until_rebuild == 0) rebuild();
+        }
+
+        const AdaptiveOptions& settings() const { return options; }
+    };
+
+
+    class AdaptiveEncoder {
+    private:
+        AdaptiveModel model;
+        std::vector<std::uint8_t> payload;      // 当前块的比特流, 按 max_chunk 个最长码字预先分配
+        BitWriter writer;
+        std::uint64_t chunk_symbols = 0;
+        std::uint64_t chunk_bits = 0;
+        bool header_written = false;
+
+        void writeHeader(std::vector<std::uint8_t>& out) {
+            out.insert(out.end(), ADAPTIVE_MAGIC.begin(), ADAPTIVE_MAGIC.end());
+            out.push_back(ADAPTIVE_VERSION);
+            writeVarint(out, model.settings().max_interval);
+            writeVarint(out, model.settings().decay_threshold);
+            writeVarint(out, model.settings().max_chunk);
+            header_written = true;
+        }
+
+    public:
+        explicit AdaptiveEncoder(const AdaptiveOptions& options = {})
+            : model(options, false), payload(options.max_chunk * MAX_CODE_LENGTH / 8 + 16), writer(payload.data()) {}
+
+        AdaptiveEncoder(const AdaptiveEncoder&) = delete;
+        AdaptiveEncoder& operator=(const AdaptiveEncoder&) = delete;
+
+
+        // 编码 data, 写满的块追加到 out
+        void write(std::span<const std::uint8_t> data, std::vector<std::uint8_t>& out) {
+            if (!header_written) writeHeader(out);
+            while (!data.empty()) {
+                std::uint64_t n = std::min<std::uint64_t>({data.size(), model.remaining(), model.settings().max_chunk - chunk_symbols});
+                std::span<const std::uint8_t> part = data.first(static_cast<std::size_t>(n));
+                chunk_bits += model.codeTable().encode(writer, part.data(), part.size());
+                chunk_symbols += n;
+                model.update(part);
+                data = data.subspan(static_cast<std::size_t>(n));
+                if (chunk_symbols == model.settings().max_chunk) flush(out);
+            }
+        }
+
+        // 把尚未输出的字节作为一个块追加到 out, 解码端收到后即可还原到这里为止的全部数据
+        void flush(std::vector<std::uint8_t>& out) {
+            if (!header_written) writeHeader(out);
+            if (chunk_symbols == 0) return;
+            std::size_t bytes = writer.finish();
+            writeVarint(out, chunk_symbols);
+            writeVarint(out, chunk_bits);
+            out.insert(out.end(), payload.begin(), payload.begin() + static_cast<std::ptrdiff_t>(bytes));
+            writer = BitWriter(payload.data());
+            chunk_symbols = 0;
+            chunk_bits = 0;
+        }
+    };
+
+
+    class AdaptiveDecoder {
+    private:
+        std::vector<std::uint8_t> pending;      // 还不完整的头部或数据块
+        std::optional<AdaptiveModel> model;     // 读到头部之后才能创建
+
+        // 尝试从 pending 的 pos 处读一个 varint, 数据不够时返回 false
+        static bool tryVarint(std::span<const std::uint8_t> in, std::size_t& pos, std::uint64_t& v) {
+            std::size_t end = pos;
+            while (end < in.size() && (in[end] & 0x80)) ++end;
+            if (end >= in.size()) {
+                if (end - pos >= 10) throw std::invalid_argument("huffman: malformed varint");
+                return false;
+            }
+            v = readVarint(in, pos);
+            return true;
+        }
+
+        // 解析头部, 数据不够时返回 0, 否则返回头部的字节数
+        std::size_t parseHeader(std::span<const std::uint8_t> in) {
+            if (in.size() < ADAPTIVE_MAGIC.size() + 1) return 0;
+            if (!std::equal(ADAPTIVE_MAGIC.begin(), ADAPTIVE_MAGIC.end(), in.begin())) {
+                throw std::invalid_argument("huffman: not an adaptive stream");
+            }
+            if (in[ADAPTIVE_MAGIC.size()] != ADAPTIVE_VERSION) throw std::invalid_argument("huffman: unsupported adaptive version");
+            std::size_t pos = ADAPTIVE_MAGIC.size() + 1;
+            AdaptiveOptions options;
+            if (!tryVarint(in, pos, options.max_interval) || !tryVarint(in, pos, options.decay_threshold) ||
+                !tryVarint(in, pos, options.max_chunk)) {
+                return 0;
+            }
+            model.emplace(options, true);
+            return pos;
+        }
+
+        // 解码一个完整的块, 数据不够时返回 0, 否则返回块的字节数
+        std::size_t decodeChunk(std::span<const std::uint8_t> in, std::vector<std::uint8_t>& out) {
+            std::size_t pos = 0;
+            std::uint64_t symbols = 0;
+            std::uint64_t bits = 0;
+            if (!tryVarint(in, pos, symbols) || !tryVarint(in, pos, bits)) return 0;
+            AdaptiveModel& m = *model;
+            if (symbols == 0 || symbols > m.settings().max_chunk || bits > symbols * MAX_CODE_LENGTH) {
+                throw std::invalid_argument("huffman: corrupt adaptive chunk");
+            }
+            std::uint64_t bytes = (bits + 7) / 8;
+            if (in.size() - pos < bytes) return 0;
+
+            BitReader reader(in.data() + pos, static_cast<std::size_t>(bytes));
+            std::uint64_t consumed = 0;
+            std::size_t base = out.size();
+            out.resize(base + symbols);
+            for (std::uint64_t done = 0; done < symbols;) {
+                std::uint64_t n = std::min(symbols - done, m.remaining());
+                std::uint8_t* dst = out.data() + base + done;
+                m.codeTable().decode(reader, dst, n, consumed);
+                m.update({dst, static_cast<std::size_t>(n)});
+                done += n;
+            }
+            if (consumed != bits) throw std::invalid_argument("huffman: corrupt adaptive chunk");
+            return pos + static_cast<std::size_t>(bytes);
+        }
+
+    public:
+        AdaptiveDecoder() = default;
+
+        /*
+         * 输入任意长度的片段, 解码出的字节追加到 out。不完整的块先缓存, 等后续数据到达后再解码。
+         * 数据损坏时抛出 invalid_argument。
+         */
+        void feed(std::span<const std::uint8_t> data, std::vector<std::uint8_t>& out) {
+            pending.insert(pending.end(), data.begin(), data.end());
+            std::size_t pos = 0;
+            if (!model) {
+                pos = parseHeader(pending);
+                if (pos == 0) return;
+            }
+            while (pos < pending.size()) {
+                std::size_t used = decodeChunk(std::span(pending).subspan(pos), out);
+                if (used == 0) break;
+                pos += used;
+            }
+            pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(pos));
+        }
+
+        // 没有缓存未完成的数据, 即已经收到的数据都解码完毕; 输入结束时为 false 说明流被截断
+        bool idle() const { return pending.empty(); }
+    };
+
+} // namespace huffman
@@ -0,0 +1,138 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+
+namespace huffman {
+    // 打包后的比特流: 高位在前, 最后一个字节不足 8 位时低位补 0
+    struct PackedBits {
+        std::vector<std::uint8_t> bytes;
+        std::uint64_t bits = 0;         // 有效比特数
+        std::uint64_t symbols = 0;      // 编码的符号个数
+    };
+
+
+    // LEB128 变长整数: 每字节 7 位, 最高位表示后面还有字节
+    inline void writeVarint(std::vector<std::uint8_t>& out, std::uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<std::uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(v));
+    }
+
+    inline std::uint64_t readVarint(std::span<const std::uint8_t> in, std::size_t& pos) {
+        std::uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (pos >= in.size()) throw std::invalid_argument("huffman: truncated varint");
+            std::uint8_t b = in[pos++];
+            v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+            if ((b & 0x80) == 0) return v;
+        }
+        throw std::invalid_argument("huffman: malformed varint");
+    }
+
+
+    // 按大端序读取 8 个字节, 第一个字节位于结果的最高 8 位
+    inline std::uint64_t loadBigEndian64(const std::uint8_t* p) {
+        std::uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if constexpr (std::endian::native == std::endian::little) v = std::byteswap(v);
+        return v;
+    }
+
+
+    inline void storeBigEndian64(std::uint8_t* p, std::uint64_t v) {
+        if constexpr (std::endian::native == std::endian::little) v = std::byteswap(v);
+        std::memcpy(p, &v, sizeof(v));
+    }
+
+
+    /*
+     * 写入预先分配好的缓冲区, 码字右对齐存放在 code 的低 length 位。
+     * put 只把码字或进 64 位累加器; flush 一次写出累加器的全部 8 个字节, 按完整的字节数前进,
+     * 不足一个字节的比特留在累加器里。两次 flush 之间 put 的总长度不能超过 56 位,
+     * 缓冲区末尾要比实际输出多留 8 个字节。
+     */
+    class BitWriter {
+    private:
+        std::uint8_t* begin;
+        std::uint8_t* p;
+        std::uint64_t acc = 0;          // 待写出的比特, 左对齐
+        unsigned count = 0;             // acc 中的比特数
+
+    public:
+        explicit BitWriter(std::uint8_t* dst) : begin(dst), p(dst) {}
+
+        // 1 <= length, count + length <= 64
+        void put(std::uint64_t code, unsigned length) {
+            acc |= code << (64 - count - length);
+            count += length;
+        }
+
+        void flush() {
+            storeBigEndian64(p, acc);
+            p += count >> 3;
+            acc <<= count & ~7u;
+            count &= 7;
+        }
+
+        // 写出剩余的比特, 返回输出的字节数
+        std::size_t finish() {
+            flush();
+            return static_cast<std::size_t>(p - begin) + (count > 0);
+        }
+    };
+
+
+    /*
+     * 从高位开始读取比特流。缓冲区是一个 64 位整数, 有效比特左对齐, 取前 n 位只需要一次移位。
+     * refill 之后至少有 56 个有效比特; 剩余数据不少于 8 字节时一次装入 8 个字节,
+     * 按已有的比特数决定前进几个字节, 没有逐字节的循环。读到末尾之后补 0,
+     * 调用者根据消耗的比特数判断数据是否完整。
+     */
+    class BitReader {
+    private:
+        const std::uint8_t* p;
+        const std::uint8_t* end;
+        std::uint64_t buf = 0;
+        unsigned count = 0;
+
+        // 剩余不足 8 字节时逐字节装入。单独成函数, 强制内联的 refill 只保留常见路径
+        void refillTail() {
+            while (count <= 56) {
+                if (p < end) buf |= static_cast<std::uint64_t>(*p++) << (56 - count);
+                count += 8;
+            }
+        }
+
+    public:
+        BitReader(const std::uint8_t* data, std::size_t size) : p(data), end(data + size) {}
+
+        [[gnu::always_inline]] void refill() {
+            if (end - p >= 8) [[likely]] {
+                // 装入的超出 count 的部分与下一次装入的内容相同, 重复或运算不影响结果
+                buf |= loadBigEndian64(p) >> count;
+                p += (63 - count) >> 3;
+                count |= 56;
+            }
+            else {
+                refillTail();
+            }
+        }
+
+        // 最前面的 n 位, 1 <= n <= count
+        [[gnu::always_inline]] std::uint64_t peek(unsigned n) const { return buf >> (64 - n); }
+
+        [[gnu::always_inline]] void consume(unsigned n) {
+            buf <<= n;
+            count -= n;
+        }
+    };
+
+} // namespace huffman
@@ -0,0 +1,203 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "./CodeTable.h"
+#include "./Histogram.h"
+#include "./ThreadPool.h"
+
+
+namespace huffman {
+    /*
+     * 文件级的分块压缩。输入按固定大小切块, 每块单独统计频率、单独带一张码表,
+     * 块之间没有依赖, 可以并行编码和解码; 同时在途的块数有上限, 内存占用与输入大小无关。
+     *
+     * 容器格式:
+     *   [魔数 "HUFB"][版本号 1 字节][块大小 varint]
+     *   每块: [varint: 数据长度 << 1 | 是否原样存储][数据]
+     *   结束: varint 0
+     * 压缩后不比原文小的块(例如随机数据)原样存储, 数据即原文; 否则数据是 writeBlock 的输出。
+     */
+    inline constexpr std::array<std::uint8_t, 4> CONTAINER_MAGIC{'H', 'U', 'F', 'B'};
+    inline constexpr std::uint8_t CONTAINER_VERSION = 1;
+    inline constexpr std::size_t MIN_BLOCK_SIZE = 1 << 10;
+    inline constexpr std::size_t MAX_BLOCK_SIZE = 64 << 20;
+    inline constexpr std::size_t MAX_THREADS = 1024;       // 工作线程数的上限, 更大的值按上限处理
+
+    struct BlockOptions {
+        std::size_t block_size = 128 << 10;
+        std::size_t threads = 0;            // 0 表示 hardware_concurrency
+    };
+
+    struct StreamStats {
+        std::uint64_t bytes_in = 0;
+        std::uint64_t bytes_out = 0;
+        std::uint64_t blocks = 0;
+    };
+
+
+    struct EncodedBlock {
+        std::vector<std::uint8_t> data;
+        bool raw = false;
+    };
+
+    // 压缩一个块, 码表由块内的字节频率构建
+    inline EncodedBlock compressBlock(std::span<const std::uint8_t> in) {
+        Histogram freqs{};
+        countBytes(in, freqs);
+        EncodedBlock block;
+        writeBlock(CodeTable(freqs), in, block.data);
+        if (block.data.size() >= in.size()) {
+            block.data.assign(in.begin(), in.end());
+            block.raw = true;
+        }
+        return block;
+    }
+
+    // 解压一个块, 结果不能超过 limit 字节
+    inline std::vector<std::uint8_t> decompressBlock(std::span<const std::uint8_t> in, bool raw, std::size_t limit) {
+        if (raw) return {in.begin(), in.end()};
+        std::vector<std::uint8_t> out;
+        if (readBlock(in, out) != in.size()) throw std::invalid_argument("huffman: trailing bytes in block");
+        if (out.size() > limit) throw std::invalid_argument("huffman: block larger than declared block size");
+        return out;
+    }
+
+
+    namespace detail {
+        inline void writeBytes(std::ostream& out, const std::uint8_t* data, std::size_t size, StreamStats& stats) {
+            out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+            if (!out) throw std::runtime_error("huffman: write error");
+            stats.bytes_out += size;
+        }
+
+        inline void writeStreamVarint(std::ostream& out, std::uint64_t v, StreamStats& stats) {
+            std::vector<std::uint8_t> buf;
+            writeVarint(buf, v);
+            writeBytes(out, buf.data(), buf.size(), stats);
+        }
+
+        // 读取一个 varint; 在第一个字节之前遇到文件末尾时返回 false
+        inline bool readStreamVarint(std::istream& in, std::uint64_t& v, StreamStats& stats) {
+            v = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7) {
+                int c = in.get();
+                if (c == std::istream::traits_type::eof()) {
+                    if (shift == 0) return false;
+                    throw std::invalid_argument("huffman: truncated varint");
+                }
+                ++stats.bytes_in;
+                v |= static_cast<std::uint64_t>(c & 0x7f) << shift;
+                if ((c & 0x80) == 0) return true;
+            }
+            throw std::invalid_argument("huffman: malformed varint");
+        }
+
+        inline std::size_t poolSize(std::size_t threads) {
+            if (threads == 0) threads = std::thread::hardware_concurrency();
+            return threads == 0 ? 1 : std::min(threads, MAX_THREADS);
+        }
+    } // namespace detail
+
+
+    /*
+     * 从 in 读到文件末尾, 压缩后写入 out。每个线程最多同时有两个块在途,
+     * 读入、编码与按顺序写出重叠进行。I/O 错误抛出 runtime_error。
+     */
+    inline StreamStats compressStream(std::istream& in, std::ostream& out, const BlockOptions& options = {}) {
+        if (options.block_size < MIN_BLOCK_SIZE || options.block_size > MAX_BLOCK_SIZE) {
+            throw std::invalid_argument("huffman: block size out of range");
+        }
+        StreamStats stats;
+        ThreadPool pool(detail::poolSize(options.threads));
+        const std::size_t window = 2 * pool.size();
+        std::deque<std::future<EncodedBlock>> pending;
+
+        auto writeFront = [&] {
+            EncodedBlock block = pending.front().get();
+            pending.pop_front();
+            detail::writeStreamVarint(out, (std::uint64_t{block.data.size()} << 1) | block.raw, stats);
+            detail::writeBytes(out, block.data.data(), block.data.size(), stats);
+            ++stats.blocks;
+        };
+
+        detail::writeBytes(out, CONTAINER_MAGIC.data(), CONTAINER_MAGIC.size(), stats);
+        detail::writeBytes(out, &CONTAINER_VERSION, 1, stats);
+        detail::writeStreamVarint(out, options.block_size, stats);
+
+        for (;;) {
+            std::vector<std::uint8_t> chunk(options.block_size);
+            in.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+            std::size_t n = static_cast<std::size_t>(in.gcount());
+            if (in.bad()) throw std::runtime_error("huffman: read error");
+            if (n == 0) break;
+            chunk.resize(n);
+            stats.bytes_in += n;
+            pending.push_back(pool.submit([chunk = std::move(chunk)] { return compressBlock(chunk); }));
+            if (pending.size() >= window) writeFront();
+            if (n < options.block_size) break;
+        }
+        while (!pending.empty()) writeFront();
+        detail::writeStreamVarint(out, 0, stats);
+        return stats;
+    }
+
+
+    // 解压 compressStream 的输出。格式错误或数据损坏时抛出 invalid_argument, I/O 错误抛出 runtime_error
+    inline StreamStats decompressStream(std::istream& in, std::ostream& out, std::size_t threads = 0) {
+        StreamStats stats;
+        std::array<std::uint8_t, CONTAINER_MAGIC.size() + 1> header{};
+        in.read(reinterpret_cast<char*>(header.data()), static_cast<std::streamsize>(header.size()));
+        if (static_cast<std::size_t>(in.gcount()) != header.size() ||
+            !std::equal(CONTAINER_MAGIC.begin(), CONTAINER_MAGIC.end(), header.begin())) {
+            throw std::invalid_argument("huffman: not a compressed stream");
+        }
+        if (header.back() != CONTAINER_VERSION) throw std::invalid_argument("huffman: unsupported container version");
+        stats.bytes_in = header.size();
+        std::uint64_t block_size = 0;
+        if (!detail::readStreamVarint(in, block_size, stats) || block_size < MIN_BLOCK_SIZE || block_size > MAX_BLOCK_SIZE) {
+            throw std::invalid_argument("huffman: bad block size");
+        }
+
+        ThreadPool pool(detail::poolSize(threads));
+        const std::size_t window = 2 * pool.size();
+        std::deque<std::future<std::vector<std::uint8_t>>> pending;
+
+        auto writeFront = [&] {
+            std::vector<std::uint8_t> block = pending.front().get();
+            pending.pop_front();
+            detail::writeBytes(out, block.data(), block.size(), stats);
+            ++stats.blocks;
+        };
+
+        for (;;) {
+            std::uint64_t tag = 0;
+            if (!detail::readStreamVarint(in, tag, stats)) throw std::invalid_argument("huffman: missing end marker");
+            if (tag == 0) break;
+            std::uint64_t size = tag >> 1;
+            bool raw = tag & 1;
+            // 编码后的块不会比原文大, 限制长度以免损坏的数据导致过大的分配
+            if (size > block_size) throw std::invalid_argument("huffman: block too large");
+            std::vector<std::uint8_t> data(size);
+            in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+            if (static_cast<std::uint64_t>(in.gcount()) != size) throw std::invalid_argument("huffman: truncated block");
+            stats.bytes_in += size;
+            pending.push_back(pool.submit([data = std::move(data), raw, block_size] {
+                return decompressBlock(data, raw, block_size);
+            }));
+            if (pending.size() >= window) writeFront();
+        }
+        while (!pending.empty()) writeFront();
+        return stats;
+    }
+
+} // namespace huffman
@@ -0,0 +1,662 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "./BitStream.h"
+#include "./Histogram.h"
+#include "./TableDecoder.h"
+
+
+namespace huffman {
+    inline constexpr unsigned MAX_CODE_LENGTH = 15;         // 字节码表的码长上限, 解码表最多三级
+    inline constexpr unsigned MAX_WIDE_CODE_LENGTH = 24;    // 多字节符号的码长上限
+    inline constexpr std::size_t ALPHABET_SIZE = 256;
+    inline constexpr std::size_t MAX_ALPHABET = TableDecoder::MAX_VALUE + 1;   // 不同符号数的上限
+    inline constexpr std::uint8_t FORMAT_VERSION = 2;          // 比特流分成 4 条交错解码
+    inline constexpr std::uint8_t SINGLE_STREAM_VERSION = 1;   // 只有一条比特流, 小块仍使用, 旧数据可以读取
+    inline constexpr std::size_t MIN_INTERLEAVED_SYMBOLS = 256; // 更小的块分成 4 条流得不偿失
+
+
+    namespace detail {
+        // 出现过的符号按(频率, 符号)升序排列, 返回个数
+        inline std::size_t sortByFrequency(std::span<const std::uint64_t> freqs, std::span<std::uint32_t> order) {
+            std::size_t n = 0;
+            for (std::size_t s = 0; s < freqs.size(); ++s) {
+                if (freqs[s] > 0) order[n++] = static_cast<std::uint32_t>(s);
+            }
+            std::sort(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(n), [&](std::uint32_t a, std::uint32_t b) {
+                return freqs[a] != freqs[b] ? freqs[a] < freqs[b] : a < b;
+            });
+            return n;
+        }
+
+
+        /*
+         * 不限长的最优码长, Moffat-Katajainen 的原地算法, n >= 2。权重按升序放在数组 a 中:
+         * 第一遍从左到右做两队列合并, 内部节点依次覆盖已经用掉的位置, 并在被合并时改写为父节点下标;
+         * 第二遍从右到左由父节点下标算出内部节点的深度; 第三遍按深度逐层统计可用位置, 得到叶子深度。
+         * 除 n 项的数组 a 外不需要任何内存, O(n)。返回最大码长。
+         */
+        inline unsigned minimumRedundancyLengths(std::span<const std::uint64_t> freqs, std::span<const std::uint32_t> order,
+                                                 std::size_t n, std::span<std::uint8_t> lengths, std::span<std::uint64_t> a) {
+            for (std::size_t i = 0; i < n; ++i) a[i] = freqs[order[i]];
+
+            a[0] += a[1];
+            std::size_t root = 0;
+            std::size_t leaf = 2;
+            for (std::size_t next = 1; next < n - 1; ++next) {
+                if (leaf >= n || a[root] < a[leaf]) {
+                    a[next] = a[root];
+                    a[root++] = next;
+                }
+                else {
+                    a[next] = a[leaf++];
+                }
+                if (leaf >= n || (root < next && a[root] < a[leaf])) {
+                    a[next] += a[root];
+                    a[root++] = next;
+                }
+                else {
+                    a[next] += a[leaf++];
+                }
+            }
+
+            a[n - 2] = 0;
+            for (std::size_t next = n - 2; next-- > 0;) a[next] = a[a[next]] + 1;
+
+            std::size_t available = 1;
+            std::size_t used = 0;
+            std::uint64_t depth = 0;
+            std::ptrdiff_t inner = static_cast<std::ptrdiff_t>(n) - 2;
+            std::size_t next = n;
+            while (available > 0) {
+                while (inner >= 0 && a[inner] == depth) {
+                    ++used;
+                    --inner;
+                }
+                while (available > used) {
+                    a[--next] = depth;
+                    --available;
+                }
+                available = 2 * used;
+                ++depth;
+                used = 0;
+            }
+
+            unsigned longest = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                lengths[order[i]] = static_cast<std::uint8_t>(a[i]);
+                longest = std::max(longest, static_cast<unsigned>(a[i]));
+            }
+            return longest;
+        }
+
+
+        // packageMerge 需要的临时空间(64 位字数): 叶子 n, 相邻两层的权重各 2n, 每层一个位图
+        inline constexpr std::size_t packageMergeWords(std::size_t n, unsigned maxLength) {
+            return 5 * n + maxLength * ((2 * n + 63) / 64);
+        }
+
+
+        /*
+         * 限制最大码长的最优码长(package-merge)。把每个符号看作宽度为 2^-1 的硬币, 从最窄的一层开始,
+         * 每层把上一层的物品按权重两两打包, 与本层的符号归并; 最后一层取权重最小的 2n - 2 个物品,
+         * 一个符号被取中的次数就是它的码长。每层取中的前缀里, 符号一定是按权重排序后的前若干个,
+         * 打包物品的个数决定下一层要取的前缀长度, 因此只需记录每个物品是不是打包物品。
+         * 权重只保留相邻两层, 标记用位图, 都放在 work 中。O(n * maxLength)。
+         */
+        inline void packageMerge(std::span<const std::uint64_t> freqs, std::span<const std::uint32_t> order,
+                                 std::size_t n, unsigned maxLength, std::span<std::uint8_t> lengths, std::span<std::uint64_t> work) {
+            const std::size_t words = (2 * n + 63) / 64;    // 每层的物品不超过 2n - 1 个
+            std::uint64_t* leaves = work.data();
+            std::uint64_t* prev = leaves + n;
+            std::uint64_t* cur = prev + 2 * n;
+            std::uint64_t* packages = cur + 2 * n;
+            std::fill_n(packages, maxLength * words, 0);
+            for (std::size_t i = 0; i < n; ++i) leaves[i] = freqs[order[i]];
+            std::copy_n(leaves, n, prev);
+            std::size_t prev_size = n;
+
+            for (unsigned level = 1; level < maxLength; ++level) {
+                std::size_t size = 0;
+                std::size_t leaf = 0;
+                std::size_t pair = 0;
+                while (leaf < n || pair + 1 < prev_size) {
+                    std::uint64_t packed = pair + 1 < prev_size ? prev[pair] + prev[pair + 1] : UINT64_MAX;
+                    if (leaf < n && leaves[leaf] <= packed) {
+                        cur[size] = leaves[leaf++];
+                    }
+                    else {
+                        cur[size] = packed;
+                        packages[level * words + size / 64] |= std::uint64_t{1} << (size % 64);
+                        pair += 2;
+                    }
+                    ++size;
+                }
+                std::swap(prev, cur);
+                prev_size = size;
+            }
+
+            for (std::size_t i = 0; i < n; ++i) lengths[order[i]] = 0;
+            std::size_t take = 2 * n - 2;
+            for (unsigned level = maxLength; level-- > 0;) {
+                // 前 take 个物品中打包物品的个数
+                const std::uint64_t* marks = packages + level * words;
+                std::size_t packed = 0;
+                for (std::size_t w = 0; w < take / 64; ++w) packed += std::popcount(marks[w]);
+                if (take % 64) packed += std::popcount(marks[take / 64] & ((std::uint64_t{1} << (take % 64)) - 1));
+                for (std::size_t i = 0; i < take - packed; ++i) ++lengths[order[i]];
+                take = 2 * packed;
+            }
+        }
+
+
+        // order 至少 freqs.size() 项, work 至少 freqs.size() 项; work 放不下 package-merge 时临时分配
+        inline void codeLengths(std::span<const std::uint64_t> freqs, std::span<std::uint8_t> lengths, unsigned maxLength,
+                                std::span<std::uint32_t> order, std::span<std::uint64_t> work) {
+            std::size_t n = sortByFrequency(freqs, order);
+            if (n == 0) return;
+            if (n == 1) {
+                lengths[order[0]] = 1;
+                return;
+            }
+            if ((std::size_t{1} << maxLength) < n) throw std::invalid_argument("huffman: max code length too small");
+            if (minimumRedundancyLengths(freqs, order, n, lengths, work) <= maxLength) return;
+            std::size_t words = packageMergeWords(n, maxLength);
+            if (work.size() >= words) {
+                packageMerge(freqs, order, n, maxLength, lengths, work);
+                return;
+            }
+            std::vector<std::uint64_t> more(words);
+            packageMerge(freqs, order, n, maxLength, lengths, more);
+        }
+    } // namespace detail
+
+
+    /*
+     * 每个符号的码长写入 lengths, freqs 中为 0 的符号码长为 0, 只有一个符号时码长为 1。
+     * 先用原地算法求不限长的最优码长, 超过 maxLength 时(只在频率极度悬殊时发生)改用 package-merge。
+     * 不超过 256 个符号时临时数组都在栈上, 不分配堆内存。
+     */
+    inline void limitedCodeLengths(std::span<const std::uint64_t> freqs, std::span<std::uint8_t> lengths,
+                                   unsigned maxLength = MAX_CODE_LENGTH) {
+        if (freqs.size() > MAX_ALPHABET || lengths.size() < freqs.size()) throw std::invalid_argument("huffman: alphabet too large");
+        if (maxLength == 0 || maxLength > MAX_WIDE_CODE_LENGTH) throw std::invalid_argument("huffman: bad max code length");
+        std::fill(lengths.begin(), lengths.end(), 0);
+        if (freqs.size() <= ALPHABET_SIZE) {
+            std::array<std::uint32_t, ALPHABET_SIZE> order;
+            std::array<std::uint64_t, detail::packageMergeWords(ALPHABET_SIZE, MAX_WIDE_CODE_LENGTH)> work;
+            detail::codeLengths(freqs, lengths, maxLength, order, work);
+            return;
+        }
+        std::vector<std::uint32_t> order(freqs.size());
+        std::vector<std::uint64_t> work(freqs.size());
+        detail::codeLengths(freqs, lengths, maxLength, order, work);
+    }
+
+
+    /*
+     * 范式 Huffman 编码。码字只由码长决定: 按(码长, 符号)排序后依次分配递增的码字,
+     * 码长变长时左移补 0。因此序列化时只需要写出每个符号的码长, 解码端可以还原出完全相同的码字。
+     *
+     * Symbol 是字节时码字放在 256 项的数组中, 构建不分配堆内存, 码长不超过 15。
+     * 多字节符号(uint16_t 词元编号、uint32_t 整数等)的码长不超过 24, 码字有两种存放方式:
+     * 稠密时以符号值为下标, 编码只查一次数组; 稀疏时只保存出现过的符号, 按值升序排列,
+     * 编码时在开放寻址的散列表中查出符号的序号, 解码先得到符号的序号再换成符号。
+     * 由 SymbolHistogram 构建时跟随它的形式。
+     * 两种方式下码字都按符号值的顺序分配, 同一组码长得到相同的编码。
+     */
+    template<typename Symbol>
+    class BasicCodeTable {
+        static_assert(std::is_unsigned_v<Symbol> && sizeof(Symbol) <= 4, "huffman: symbols must be unsigned integers up to 32 bits");
+
+    public:
+        static constexpr bool WIDE = sizeof(Symbol) > 1;
+        static constexpr unsigned MAX_LENGTH = WIDE ? MAX_WIDE_CODE_LENGTH : MAX_CODE_LENGTH;
+
+    private:
+        using Codes = std::conditional_t<WIDE, std::vector<Code>, std::array<Code, ALPHABET_SIZE>>;
+        static constexpr Code ABSENT{};
+
+        Codes codes{};                  // 以下标 index(s) 存放符号 s 的码字
+        std::vector<Symbol> symbols;    // 稀疏时为升序排列的符号, 稠密时为空
+        // 稀疏时符号到下标的散列表, 线性探测, 装载率不超过 1/2; index 为下标加一, 0 表示空槽
+        struct Slot {
+            Symbol symbol;
+            std::uint32_t index;
+        };
+        std::vector<Slot> slots;
+        unsigned slot_shift = 64;
+        TableDecoder decoder;
+        unsigned max_length = 0;
+
+
+        // 由每个下标的码长分配范式码字; 码长超过上限或不满足 Kraft 不等式时抛出 invalid_argument
+        void assignLengths(std::span<const std::uint8_t> lengths) {
+            if (lengths.size() > (WIDE ? MAX_ALPHABET : ALPHABET_SIZE)) throw std::invalid_argument("huffman: alphabet too large");
+            std::array<std::uint32_t, MAX_LENGTH + 1> count{};
+            for (std::uint8_t len : lengths) {
+                if (len > MAX_LENGTH) throw std::invalid_argument("huffman: code length too large");
+                ++count[len];
+            }
+            count[0] = 0;
+            // Kraft 和以 2^-MAX_LENGTH 为单位
+            std::uint64_t kraft = 0;
+            for (unsigned len = 1; len <= MAX_LENGTH; ++len) kraft += std::uint64_t{count[len]} << (MAX_LENGTH - len);
+            if (kraft > (std::uint64_t{1} << MAX_LENGTH)) throw std::invalid_argument("huffman: over-subscribed code lengths");
+
+            // 每种码长的第一个码字
+            std::array<std::uint64_t, MAX_LENGTH + 1> next{};
+            std::uint64_t code = 0;
+            for (unsigned len = 1; len <= MAX_LENGTH; ++len) {
+                code = (code + count[len - 1]) << 1;
+                next[len] = code;
+            }
+            if constexpr (WIDE) codes.assign(lengths.size(), {});
+            else codes.fill({});
+            max_length = 0;
+            for (std::size_t s = 0; s < lengths.size(); ++s) {
+                unsigned len = lengths[s];
+                if (len == 0) continue;
+                codes[s] = {next[len]++, static_cast<std::uint8_t>(len)};
+                max_length = std::max(max_length, len);
+            }
+        }
+
+        // 稀疏码表解码得到的是符号的序号, 换成符号
+        template<typename Out>
+        void toSymbols(Out* out, std::uint64_t n) const {
+            if constexpr (WIDE) {
+                if (symbols.empty()) return;
+                for (std::uint64_t i = 0; i < n; ++i) out[i] = static_cast<Out>(symbols[static_cast<std::size_t>(out[i])]);
+            }
+        }
+
+    public:
+        BasicCodeTable() = default;
+
+        // 由每个符号的出现次数构建
+        explicit BasicCodeTable(std::span<const std::uint64_t> freqs, unsigned maxLength = MAX_LENGTH) {
+            build(freqs, maxLength);
+        }
+
+        explicit BasicCodeTable(const SymbolHistogram<Symbol>& freqs, unsigned maxLength = MAX_LENGTH) {
+            build(freqs, maxLength);
+        }
+
+
+        /*
+         * freqs[i] 为 sorted[i] 的出现次数; sorted 为空时 freqs[s] 为符号 s 的出现次数。
+         * 只生成编码用的码字, 解码前还要调用 buildDecoder。字节码表不分配堆内存。
+         */
+        void build(std::span<const std::uint64_t> freqs, std::span<const Symbol> sorted, unsigned maxLength = MAX_LENGTH) {
+            if (maxLength > MAX_LENGTH) throw std::invalid_argument("huffman: bad max code length");
+            if constexpr (WIDE) {
+                std::vector<std::uint8_t> lengths(freqs.size());
+                limitedCodeLengths(freqs, lengths, maxLength);
+                if (sorted.empty()) assign(lengths);
+                else assign(sorted, lengths);
+            }
+            else {
+                // 字节码表总是稠密的
+                Histogram dense{};
+                if (!sorted.empty()) {
+                    if (sorted.size() != freqs.size()) throw std::invalid_argument("huffman: symbol and count sizes differ");
+                    for (std::size_t i = 0; i < sorted.size(); ++i) dense[sorted[i]] = freqs[i];
+                    freqs = dense;
+                }
+                std::array<std::uint8_t, ALPHABET_SIZE> lengths;
+                limitedCodeLengths(freqs, lengths, maxLength);
+                assign(lengths);
+            }
+        }
+
+        void build(std::span<const std::uint64_t> freqs, unsigned maxLength = MAX_LENGTH) {
+            build(freqs, {}, maxLength);
+        }
+
+        void build(const SymbolHistogram<Symbol>& freqs, unsigned maxLength = MAX_LENGTH) {
+            build(freqs.counts, freqs.symbols, maxLength);
+        }
+
+
+        // lengths[s] 为符号 s 的码长, 分配范式码字; 码长超过上限或不满足 Kraft 不等式时抛出 invalid_argument
+        void assign(std::span<const std::uint8_t> lengths) {
+            symbols.clear();
+            assignLengths(lengths);
+        }
+
+        // 稀疏形式: lengths[i] 为 sorted[i] 的码长, sorted 必须严格升序。只用于多字节符号
+        void assign(std::span<const Symbol> sorted, std::span<const std::uint8_t> lengths) {
+            static_assert(WIDE, "huffman: byte code tables are always dense");
+            if (sorted.size() != lengths.size()) throw std::invalid_argument("huffman: symbol and length counts differ");
+            if (std::adjacent_find(sorted.begin(), sorted.end(), std::greater_equal<>()) != sorted.end()) {
+                throw std::invalid_argument("huffman: symbols not sorted");
+            }
+            assignLengths(lengths);
+            symbols.assign(sorted.begin(), sorted.end());
+            slots.clear();
+            if (symbols.empty()) return;
+            std::size_t capacity = std::bit_ceil(symbols.size() * 2);
+            slots.assign(capacity, {});
+            slot_shift = 64 - static_cast<unsigned>(std::countr_zero(capacity));
+            for (std::size_t i = 0; i < symbols.size(); ++i) {
+                std::size_t slot = detail::symbolSlot(symbols[i], slot_shift);
+                while (slots[slot].index != 0) slot = (slot + 1) & (capacity - 1);
+                slots[slot] = {symbols[i], static_cast<std::uint32_t>(i + 1)};
+            }
+        }
+
+        // 生成查找表。编码端用不到它, 单独构建。多字节符号的码字多且长, 使用更大的一级表
+        void buildDecoder() {
+            decoder.build(codes, WIDE ? TableDecoder::MAX_ROOT_BITS : TableDecoder::ROOT_BITS);
+        }
+
+
+        // 符号在码表中的下标, 不在码表中时返回 size()。稀疏时查散列表, 装载率低, 多数符号一次命中
+        std::size_t index(Symbol symbol) const {
+            if constexpr (WIDE) {
+                if (!symbols.empty()) {
+                    std::size_t mask = slots.size() - 1;
+                    for (std::size_t slot = detail::symbolSlot(symbol, slot_shift);; slot = (slot + 1) & mask) {
+                        const Slot& s = slots[slot];
+                        if (s.symbol == symbol && s.index != 0) return s.index - 1;
+                        if (s.index == 0) return codes.size();
+                    }
+                }
+                return std::min<std::size_t>(symbol, codes.size());
+            }
+            return symbol;
+        }
+
+        // 下标 i 处的符号
+        Symbol symbol(std::size_t i) const {
+            if constexpr (WIDE) {
+                if (!symbols.empty()) return symbols[i];
+            }
+            return static_cast<Symbol>(i);
+        }
+
+        std::size_t size() const { return codes.size(); }
+        bool sparse() const { return !symbols.empty(); }
+
+        const Code& code(Symbol symbol) const {
+            if constexpr (WIDE) {
+                std::size_t i = index(symbol);
+                return i < codes.size() ? codes[i] : ABSENT;
+            }
+            return codes[symbol];
+        }
+
+        unsigned maxLength() const { return max_length; }
+
+
+        /*
+         * 编码 n 个符号写入 writer, 返回写入的比特数。每次 flush 之间写入 56 / MAX_LENGTH 个码字
+         * (字节 3 个, 不超过 45 位; 多字节符号 2 个, 不超过 48 位), 循环中没有容量检查和逐字节的写入;
+         * 调用者保证缓冲区至少还有 n * maxLength() / 8 + 8 个字节。出现码表中没有的符号时抛出 out_of_range。
+         */
+        std::uint64_t encode(BitWriter& writer, const Symbol* in, std::size_t n) const {
+            constexpr std::size_t PER_FLUSH = 56 / MAX_LENGTH;
+            std::uint64_t bits = 0;
+            auto put = [&](Symbol symbol) {
+                const Code& c = code(symbol);
+                if (c.length == 0) [[unlikely]] throw std::out_of_range("huffman: symbol not in code table");
+                writer.put(c.bits, c.length);
+                bits += c.length;
+            };
+            std::size_t i = 0;
+            for (; i + PER_FLUSH <= n; i += PER_FLUSH) {
+                for (std::size_t k = 0; k < PER_FLUSH; ++k) put(in[i + k]);
+                writer.flush();
+            }
+            for (; i < n; ++i) {
+                put(in[i]);
+                writer.flush();
+            }
+            return bits;
+        }
+
+        // 编码 n 个符号, 输出缓冲区按最长码字预先分配
+        PackedBits encode(const Symbol* in, std::size_t n) const {
+            PackedBits out;
+            out.symbols = n;
+            out.bytes.resize(n * max_length / 8 + 16);
+            BitWriter writer(out.bytes.data());
+            out.bits = encode(writer, in, n);
+            out.bytes.resize(writer.finish());
+            return out;
+        }
+
+
+        template<typename Out>
+        void decode(BitReader& reader, Out* out, std::uint64_t n, std::uint64_t& consumed) const {
+            decoder.decode(reader, out, n, consumed);
+            toSymbols(out, n);
+        }
+
+        template<typename Out>
+        void decode(const PackedBits& in, Out* out) const {
+            decoder.decode(in, out);
+            toSymbols(out, in.symbols);
+        }
+
+        // 交错解码 4 条比特流, 见 TableDecoder::decodeInterleaved
+        template<typename Out>
+        void decodeInterleaved(std::array<BitReader, TableDecoder::STREAMS>& readers, const std::array<Out*, TableDecoder::STREAMS>& out,
+                               const std::array<std::uint64_t, TableDecoder::STREAMS>& n,
+                               std::array<std::uint64_t, TableDecoder::STREAMS>& consumed) const {
+            decoder.decodeInterleaved(readers, out, n, consumed);
+            for (unsigned k = 0; k < TableDecoder::STREAMS; ++k) toSymbols(out[k], n[k]);
+        }
+
+
+        /*
+         * 码长表的序列化格式。字节码表: 第一个字节是出现的最大字节值 m, 之后 (m + 2) / 2 个字节依次存放
+         * 符号 0..m 的码长, 每个字节两个, 前一个在高 4 位。码长不超过 15, 4 位足够。
+         * 多字节符号只写出现的符号: [符号个数 varint][第一个符号 varint][之后每个符号与前一个的差减 1, varint]
+         * [每个符号的码长, 各 1 字节]。稠密的小字母表差值都是 0, 每个符号 2 个字节。
+         */
+        void writeLengths(std::vector<std::uint8_t>& out) const {
+            if constexpr (WIDE) {
+                std::size_t used = 0;
+                for (const Code& c : codes) used += c.length != 0;
+                writeVarint(out, used);
+                std::uint64_t prev = 0;
+                bool first = true;
+                for (std::size_t i = 0; i < codes.size(); ++i) {
+                    if (codes[i].length == 0) continue;
+                    std::uint64_t s = symbol(i);
+                    writeVarint(out, first ? s : s - prev - 1);
+                    prev = s;
+                    first = false;
+                }
+                for (const Code& c : codes) {
+                    if (c.length != 0) out.push_back(c.length);
+                }
+                return;
+            }
+            std::size_t used = 0;
+            for (std::size_t s = 0; s < ALPHABET_SIZE; ++s) {
+                if (codes[s].length != 0) used = s + 1;
+            }
+            used = std::max<std::size_t>(used, 1);
+            out.push_back(static_cast<std::uint8_t>(used - 1));
+            for (std::size_t s = 0; s < used; s += 2) {
+                std::uint8_t hi = codes[s].length;
+                std::uint8_t lo = s + 1 < used ? codes[s + 1].length : 0;
+                out.push_back(static_cast<std::uint8_t>(hi << 4 | lo));
+            }
+        }
+
+        // 读取 writeLengths 的输出并重建码表, 返回读取的字节数。最大符号小于 DENSE_ALPHABET 时使用稠密形式
+        std::size_t readLengths(std::span<const std::uint8_t> in) {
+            if constexpr (WIDE) {
+                std::size_t pos = 0;
+                std::uint64_t used = readVarint(in, pos);
+                // 每个符号至少 2 个字节, 损坏的头部不会导致过大的分配
+                if (used > MAX_ALPHABET || used > (in.size() - pos) / 2) throw std::invalid_argument("huffman: truncated header");
+                std::vector<Symbol> sorted(used);
+                std::uint64_t s = 0;
+                for (std::size_t i = 0; i < used; ++i) {
+                    std::uint64_t delta = readVarint(in, pos);
+                    s = i == 0 ? delta : s + delta + 1;
+                    if (delta > std::numeric_limits<Symbol>::max() || s > std::numeric_limits<Symbol>::max()) {
+                        throw std::invalid_argument("huffman: symbol out of range");
+                    }
+                    sorted[i] = static_cast<Symbol>(s);
+                }
+                if (in.size() - pos < used) throw std::invalid_argument("huffman: truncated header");
+                std::span<const std::uint8_t> lengths = in.subspan(pos, used);
+                if (std::find(lengths.begin(), lengths.end(), 0) != lengths.end()) throw std::invalid_argument("huffman: corrupt code lengths");
+                if (used > 0 && sorted.back() < DENSE_ALPHABET) {
+                    std::vector<std::uint8_t> dense(std::size_t{sorted.back()} + 1, 0);
+                    for (std::size_t i = 0; i < used; ++i) dense[sorted[i]] = lengths[i];
+                    assign(dense);
+                }
+                else {
+                    assign(sorted, lengths);
+                }
+                buildDecoder();
+                return pos + used;
+            }
+            if (in.empty()) throw std::invalid_argument("huffman: truncated header");
+            std::size_t used = std::size_t{in[0]} + 1;
+            std::size_t size = 1 + (used + 1) / 2;
+            if (in.size() < size) throw std::invalid_argument("huffman: truncated header");
+            std::array<std::uint8_t, ALPHABET_SIZE> lengths{};
+            for (std::size_t s = 0; s < used; ++s) {
+                std::uint8_t b = in[1 + s / 2];
+                lengths[s] = s % 2 == 0 ? b >> 4 : b & 0x0f;
+            }
+            assign(std::span(lengths).first(used));
+            buildDecoder();
+            return size;
+        }
+    };
+
+    using CodeTable = BasicCodeTable<std::uint8_t>;
+
+
+    namespace detail {
+        // 块的第一个字节: 低 4 位是格式版本, 高 4 位是符号字节数的以 2 为底的对数, 字节块就是版本号本身
+        template<typename Symbol>
+        inline constexpr std::uint8_t WIDTH_TAG = static_cast<std::uint8_t>((std::bit_width(sizeof(Symbol)) - 1) << 4);
+
+        // 交错格式中第 k 条流的符号数: 前几条各 ceil(n / 4) 个, 最后一条取剩余
+        inline std::uint64_t streamSymbols(std::uint64_t n, unsigned k) {
+            std::uint64_t quarter = (n + TableDecoder::STREAMS - 1) / TableDecoder::STREAMS;
+            return std::min(quarter, n - std::min(n, quarter * k));
+        }
+
+        // 比特数补齐到整字节, 头部损坏、比特数接近 2^64 时也不会回绕
+        inline std::uint64_t paddedBytes(std::uint64_t bits) {
+            return bits / 8 + (bits % 8 != 0);
+        }
+    } // namespace detail
+
+
+    /*
+     * 一个独立可解码的块, 追加到 out:
+     *   [版本号与符号宽度 1 字节][符号数 varint]
+     *   符号数不为 0 时继续: [码长表], 之后
+     *     版本 1: [有效比特数 varint][比特流]
+     *     版本 2: 符号按顺序分成 4 段分别编码, [4 条流的有效比特数 varint x 4][流 0]...[流 3], 每条流补齐到整字节
+     * 默认写出版本 2, 解码时 4 条流交错进行; 符号数少于 MIN_INTERLEAVED_SYMBOLS 或 interleaved 为 false 时写出版本 1。
+     */
+    template<typename Symbol>
+    inline void writeBlock(const BasicCodeTable<Symbol>& table, std::type_identity_t<std::span<const Symbol>> in, std::vector<std::uint8_t>& out,
+                           bool interleaved = true) {
+        interleaved = interleaved && in.size() >= MIN_INTERLEAVED_SYMBOLS;
+        out.push_back((interleaved ? FORMAT_VERSION : SINGLE_STREAM_VERSION) | detail::WIDTH_TAG<Symbol>);
+        writeVarint(out, in.size());
+        if (in.empty()) return;
+        table.writeLengths(out);
+        if (!interleaved) {
+            PackedBits packed = table.encode(in.data(), in.size());
+            writeVarint(out, packed.bits);
+            out.insert(out.end(), packed.bytes.begin(), packed.bytes.end());
+            return;
+        }
+        std::array<PackedBits, TableDecoder::STREAMS> streams;
+        std::size_t begin = 0;
+        for (unsigned k = 0; k < TableDecoder::STREAMS; ++k) {
+            std::size_t n = static_cast<std::size_t>(detail::streamSymbols(in.size(), k));
+            streams[k] = table.encode(in.data() + begin, n);
+            begin += n;
+        }
+        for (const PackedBits& s : streams) writeVarint(out, s.bits);
+        for (const PackedBits& s : streams) out.insert(out.end(), s.bytes.begin(), s.bytes.end());
+    }
+
+    // 解码 writeBlock 写出的一个块(版本 1 或 2), 追加到 out, 返回读取的字节数。数据损坏或符号宽度不符时抛出 invalid_argument
+    template<typename Symbol>
+    inline std::size_t readBlock(std::span<const std::uint8_t> in, std::vector<Symbol>& out) {
+        if (in.empty()) throw std::invalid_argument("huffman: truncated block");
+        std::uint8_t version = in[0] & 0x0f;
+        if (version != SINGLE_STREAM_VERSION && version != FORMAT_VERSION) throw std::invalid_argument("huffman: unsupported format version");
+        if ((in[0] & 0xf0) != detail::WIDTH_TAG<Symbol>) throw std::invalid_argument("huffman: symbol width mismatch");
+        std::size_t pos = 1;
+        std::uint64_t symbols = readVarint(in, pos);
+        if (symbols == 0) return pos;
+
+        BasicCodeTable<Symbol> table;
+        pos += table.readLengths(in.subspan(pos));
+        if (version == SINGLE_STREAM_VERSION) {
+            PackedBits packed;
+            packed.symbols = symbols;
+            packed.bits = readVarint(in, pos);
+            std::uint64_t bytes = detail::paddedBytes(packed.bits);
+            if (bytes > in.size() - pos) throw std::invalid_argument("huffman: truncated block");
+            // 每个符号至少 1 位, 符号数不会超过比特数, 加上面的检查, 损坏的头部不会导致过大的分配
+            if (symbols > packed.bits) throw std::invalid_argument("huffman: corrupt block header");
+            packed.bytes.assign(in.begin() + static_cast<std::ptrdiff_t>(pos), in.begin() + static_cast<std::ptrdiff_t>(pos + bytes));
+            pos += bytes;
+
+            std::size_t base = out.size();
+            out.resize(base + symbols);
+            table.decode(packed, out.data() + base);
+            return pos;
+        }
+
+        std::array<std::uint64_t, TableDecoder::STREAMS> n{};
+        std::array<std::uint64_t, TableDecoder::STREAMS> bits{};
+        std::array<std::uint64_t, TableDecoder::STREAMS> bytes{};
+        std::uint64_t total = 0;
+        for (unsigned k = 0; k < TableDecoder::STREAMS; ++k) {
+            n[k] = detail::streamSymbols(symbols, k);
+            bits[k] = readVarint(in, pos);
+            // 每个符号至少 1 位, 最多 MAX_LENGTH 位; 上限写成向上取整的除法, n[k] 很大时不会溢出
+            constexpr unsigned L = BasicCodeTable<Symbol>::MAX_LENGTH;
+            if (bits[k] < n[k] || bits[k] / L + (bits[k] % L != 0) > n[k]) throw std::invalid_argument("huffman: corrupt block header");
+            bytes[k] = detail::paddedBytes(bits[k]);
+            if (bytes[k] > in.size() - pos) throw std::invalid_argument("huffman: truncated block");
+            total += bytes[k];
+        }
+        if (total > in.size() - pos) throw std::invalid_argument("huffman: truncated block");
+
+        std::size_t base = out.size();
+        out.resize(base + symbols);
+        std::array<BitReader, TableDecoder::STREAMS> readers{
+            BitReader(in.data() + pos, bytes[0]),
+            BitReader(in.data() + pos + bytes[0], bytes[1]),
+            BitReader(in.data() + pos + bytes[0] + bytes[1], bytes[2]),
+            BitReader(in.data() + pos + bytes[0] + bytes[1] + bytes[2], bytes[3]),
+        };
+        Symbol* dst = out.data() + base;
+        std::array<Symbol*, TableDecoder::STREAMS> starts{dst, dst + n[0], dst + n[0] + n[1], dst + n[0] + n[1] + n[2]};
+        std::array<std::uint64_t, TableDecoder::STREAMS> consumed{};
+        table.decodeInterleaved(readers, starts, n, consumed);
+        if (consumed != bits) throw std::invalid_argument("huffman: corrupt bit stream");
+        return pos + total;
+    }
+
+} // namespace huffman
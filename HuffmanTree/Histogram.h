@@ -0,0 +1,252 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+
+namespace huffman {
+    using Histogram = std::array<std::uint64_t, 256>;
+
+    // 多字节符号的值都小于它时按符号值下标计数
+    inline constexpr std::size_t DENSE_ALPHABET = std::size_t{1} << 16;
+
+
+    /*
+     * 多字节符号(uint16_t 词元编号、uint32_t 整数差分等)的频率。符号值都小于 DENSE_ALPHABET 时
+     * counts 以符号值为下标, symbols 为空(稠密); 否则 symbols 是升序排列的不同符号, counts[i] 是 symbols[i]
+     * 的出现次数(稀疏), 只占用与不同符号数成正比的内存。
+     */
+    template<typename Symbol>
+    struct SymbolHistogram {
+        std::vector<std::uint64_t> counts;
+        std::vector<Symbol> symbols;
+    };
+
+
+    namespace detail {
+        // 每段最多 2^30 字节, 32 位计数器不会溢出
+        inline constexpr std::size_t HISTOGRAM_SEGMENT = std::size_t{1} << 30;
+
+        /*
+         * 连续相同的字节落在同一个计数器上时, 每次自增都要等上一次的写入完成(存储转发),
+         * 吞吐退化为每字节一次内存往返。4 个子直方图轮流使用, 相邻字节的自增互不依赖, 最后再相加。
+         * 每次读 8 个字节, 用移位取出各字节, 减少加载指令。
+         */
+        inline void countSegment(const std::uint8_t* p, std::size_t n, Histogram& out) {
+            std::uint32_t counts[4][256] = {};
+            std::size_t i = 0;
+            auto count8 = [&](std::uint64_t v) {
+                ++counts[0][v & 0xff];
+                ++counts[1][(v >> 8) & 0xff];
+                ++counts[2][(v >> 16) & 0xff];
+                ++counts[3][(v >> 24) & 0xff];
+                ++counts[0][(v >> 32) & 0xff];
+                ++counts[1][(v >> 40) & 0xff];
+                ++counts[2][(v >> 48) & 0xff];
+                ++counts[3][v >> 56];
+            };
+#if defined(__AVX2__)
+            // 32 个字节全部相同(零填充、长串空格)时只做一次加法
+            for (; i + 32 <= n; i += 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+                __m256i first = _mm256_broadcastb_epi8(_mm256_castsi256_si128(v));
+                if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, first)) == -1) {
+                    counts[0][p[i]] += 32;
+                    continue;
+                }
+                std::uint64_t words[4];
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(words), v);
+                count8(words[0]);
+                count8(words[1]);
+                count8(words[2]);
+                count8(words[3]);
+            }
+#endif
+            for (; i + 16 <= n; i += 16) {
+                std::uint64_t a, b;
+                std::memcpy(&a, p + i, 8);
+                std::memcpy(&b, p + i + 8, 8);
+                count8(a);
+                count8(b);
+            }
+            for (; i < n; ++i) ++counts[i & 3][p[i]];
+            for (std::size_t s = 0; s < 256; ++s) {
+                out[s] += std::uint64_t{counts[0][s]} + counts[1][s] + counts[2][s] + counts[3][s];
+            }
+        }
+
+        // 开放寻址表的槽位: 取 64 位乘积的高位(Fibonacci 散列), 符号值的低位全相同时也能分散开
+        inline std::size_t symbolSlot(std::uint64_t symbol, unsigned shift) {
+            return static_cast<std::size_t>((symbol * 0x9E3779B97F4A7C15ull) >> shift);
+        }
+
+        // 散列计数的不同符号数上限, 超过时表已放不进 L2, 改用基数排序
+        inline constexpr std::size_t HASH_COUNT_LIMIT = std::size_t{1} << 16;
+
+        /*
+         * 用线性探测的开放寻址表计数, 装载率不超过 1/2, 次数为 0 的槽位是空的。
+         * 不同符号数超过 HASH_COUNT_LIMIT 时返回 false, h 不变。
+         */
+        template<typename Symbol>
+        bool hashCount(std::span<const Symbol> data, SymbolHistogram<Symbol>& h) {
+            unsigned bits = 10;
+            std::vector<Symbol> keys(std::size_t{1} << bits);
+            std::vector<std::uint64_t> counts(keys.size());
+            std::size_t used = 0;
+            for (Symbol s : data) {
+                std::size_t mask = keys.size() - 1;
+                std::size_t slot = symbolSlot(s, 64 - bits);
+                while (counts[slot] != 0 && keys[slot] != s) slot = (slot + 1) & mask;
+                if (counts[slot]++ != 0) continue;
+                keys[slot] = s;
+                if (++used * 2 <= keys.size()) continue;
+                if (used > HASH_COUNT_LIMIT) return false;
+
+                // 容量翻倍, 重新放入
+                ++bits;
+                std::vector<Symbol> new_keys(std::size_t{1} << bits);
+                std::vector<std::uint64_t> new_counts(new_keys.size());
+                for (std::size_t i = 0; i < keys.size(); ++i) {
+                    if (counts[i] == 0) continue;
+                    std::size_t to = symbolSlot(keys[i], 64 - bits);
+                    while (new_counts[to] != 0) to = (to + 1) & (new_keys.size() - 1);
+                    new_keys[to] = keys[i];
+                    new_counts[to] = counts[i];
+                }
+                keys.swap(new_keys);
+                counts.swap(new_counts);
+            }
+
+            std::vector<std::pair<Symbol, std::uint64_t>> items;
+            items.reserve(used);
+            for (std::size_t i = 0; i < keys.size(); ++i) {
+                if (counts[i] != 0) items.emplace_back(keys[i], counts[i]);
+            }
+            std::sort(items.begin(), items.end());
+            h.symbols.reserve(used);
+            h.counts.reserve(used);
+            for (const auto& [symbol, count] : items) {
+                h.symbols.push_back(symbol);
+                h.counts.push_back(count);
+            }
+            return true;
+        }
+    } // namespace detail
+
+
+    // 统计每个字节值的出现次数, 累加到 out
+    inline void countBytes(std::span<const std::uint8_t> data, Histogram& out) {
+        for (std::size_t i = 0; i < data.size(); i += detail::HISTOGRAM_SEGMENT) {
+            detail::countSegment(data.data() + i, std::min(detail::HISTOGRAM_SEGMENT, data.size() - i), out);
+        }
+    }
+
+
+    /*
+     * 多线程统计: 输入切成 threads 段分别计数, 最后合并。每段至少 1MB,
+     * 数据量小时线程启动的开销超过计数本身, 自动少用线程。threads 为 0 时使用全部核。
+     */
+    inline Histogram histogram(std::span<const std::uint8_t> data, std::size_t threads = 1) {
+        constexpr std::size_t MIN_CHUNK = 1 << 20;
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::clamp<std::size_t>(data.size() / MIN_CHUNK, 1, threads);
+
+        Histogram total{};
+        if (threads == 1) {
+            countBytes(data, total);
+            return total;
+        }
+        std::size_t chunk = (data.size() + threads - 1) / threads;
+        std::vector<std::future<Histogram>> parts;
+        for (std::size_t t = 1; t < threads; ++t) {
+            std::size_t begin = std::min(t * chunk, data.size());
+            std::span<const std::uint8_t> part = data.subspan(begin, std::min(chunk, data.size() - begin));
+            parts.push_back(std::async(std::launch::async, [part] {
+                Histogram h{};
+                countBytes(part, h);
+                return h;
+            }));
+        }
+        countBytes(data.first(std::min(chunk, data.size())), total);
+        for (auto& part : parts) {
+            Histogram h = part.get();
+            for (std::size_t s = 0; s < 256; ++s) total[s] += h[s];
+        }
+        return total;
+    }
+
+
+    /*
+     * 统计多字节符号的频率。稀疏时先用开放寻址表散列计数, 只对不同的符号排序;
+     * 不同符号太多时改为按 16 位一轮做基数排序(每轮两遍顺序扫描, 比比较排序快得多), 再数连续相同的值。
+     * 基数排序每轮把数据分散写到 65536 个位置, 缓存和 TLB 都放不下, 符号少时比散列计数慢数倍。
+     */
+    template<typename Symbol>
+    SymbolHistogram<Symbol> symbolHistogram(std::span<const Symbol> data) {
+        static_assert(std::is_unsigned_v<Symbol>, "huffman: symbols must be unsigned integers");
+        SymbolHistogram<Symbol> h;
+        if (data.empty()) return h;
+        std::size_t top = *std::max_element(data.begin(), data.end());
+        if (top < DENSE_ALPHABET) {
+            h.counts.assign(top + 1, 0);
+            for (Symbol s : data) ++h.counts[s];
+            return h;
+        }
+        if (detail::hashCount(data, h)) return h;
+        std::vector<Symbol> sorted(data.begin(), data.end());
+        std::vector<Symbol> buffer(sorted.size());
+        std::vector<std::size_t> offsets(std::size_t{1} << 16);
+        for (unsigned shift = 0; shift < sizeof(Symbol) * 8; shift += 16) {
+            std::fill(offsets.begin(), offsets.end(), 0);
+            for (Symbol s : sorted) ++offsets[(s >> shift) & 0xffff];
+            std::size_t sum = 0;
+            for (auto& o : offsets) sum += std::exchange(o, sum);
+            for (Symbol s : sorted) buffer[offsets[(s >> shift) & 0xffff]++] = s;
+            sorted.swap(buffer);
+        }
+        for (std::size_t i = 0; i < sorted.size();) {
+            std::size_t j = i + 1;
+            while (j < sorted.size() && sorted[j] == sorted[i]) ++j;
+            h.symbols.push_back(sorted[i]);
+            h.counts.push_back(j - i);
+            i = j;
+        }
+        return h;
+    }
+
+    // 由(符号, 次数)的表构建, 次数不大于 0 的符号忽略
+    template<typename Symbol, typename Count>
+    SymbolHistogram<Symbol> symbolHistogram(const std::unordered_map<Symbol, Count>& freqs) {
+        static_assert(std::is_unsigned_v<Symbol>, "huffman: symbols must be unsigned integers");
+        std::vector<std::pair<Symbol, std::uint64_t>> items;
+        for (const auto& [symbol, count] : freqs) {
+            if (count > 0) items.emplace_back(symbol, static_cast<std::uint64_t>(count));
+        }
+        std::sort(items.begin(), items.end());
+        SymbolHistogram<Symbol> h;
+        if (items.empty()) return h;
+        if (items.back().first < DENSE_ALPHABET) {
+            h.counts.assign(std::size_t{items.back().first} + 1, 0);
+            for (const auto& [symbol, count] : items) h.counts[symbol] = count;
+            return h;
+        }
+        for (const auto& [symbol, count] : items) {
+            h.symbols.push_back(symbol);
+            h.counts.push_back(count);
+        }
+        return h;
+    }
+
+} // namespace huffman
@@ -0,0 +1,258 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "./CodeTable.h"
+#include "./Histogram.h"
+
+// Huffman树节点, 存放在树的节点数组中, 孩子用数组下标表示
+template<typename Symbol = char>
+struct HuffmanNode {
+    using Index = std::conditional_t<sizeof(Symbol) == 1, std::int16_t, std::int32_t>;
+
+    Symbol ch{};               // 字符
+    std::uint64_t freq = 0;    // 频率
+    Index left = -1;           // 左孩子, -1 表示叶子
+    Index right = -1;          // 右孩子
+};
+
+/*
+ * Symbol 可以是 char、uint8_t, 也可以是 uint16_t / uint32_t(词元编号、整数差分等)。
+ * 字节符号的节点和码字放在定长数组中, 建树不分配堆内存; 多字节符号按出现的符号数分配,
+ * 码表见 huffman::BasicCodeTable。char 的序列用 std::string, 其他符号类型用 std::vector<Symbol>。
+ */
+template<typename Symbol = char>
+class HuffmanTree {
+public:
+    using Node = HuffmanNode<Symbol>;
+    using Sequence = std::conditional_t<std::is_same_v<Symbol, char>, std::string, std::vector<Symbol>>;
+
+private:
+    using TableSymbol = std::make_unsigned_t<Symbol>;   // 码表中的符号, char 按无符号字节处理
+    using Index = typename Node::Index;
+    static constexpr bool WIDE = sizeof(Symbol) > 1;
+    static constexpr std::size_t MAX_NODES = 2 * huffman::ALPHABET_SIZE - 1;
+    static constexpr unsigned MAX_DEPTH = 64;   // 整数码字的上限, 频率总和小于 2^44 时不会超过
+    static constexpr huffman::Code ABSENT{};
+    
+    // 字节符号用定长数组, 多字节符号用按需分配的数组
+    template<typename T, std::size_t N>
+    using Storage = std::conditional_t<WIDE, std::vector<T>, std::array<T, N>>;
+    
+    Storage<Node, MAX_NODES> nodes{};   // 前 n 个是按频率升序的叶子, 之后是依次合并出的内部节点
+    int root = -1;
+    Storage<huffman::Code, huffman::ALPHABET_SIZE> codes{};     // 树上每个符号的码字, 下标与码表相同, 长度 0 表示不出现
+    huffman::BasicCodeTable<TableSymbol> table;     // 范式编码, 用于打包编码和查表解码
+    
+    const huffman::Code& codeOf(Symbol ch) const {
+        std::size_t i = table.index(static_cast<TableSymbol>(ch));
+        return i < codes.size() ? codes[i] : ABSENT;
+    }
+    
+    // 从根出发用显式栈遍历, 记录每个叶子的码字。只有一个字符时它的码字是 1 位的 0
+    void buildCodes(std::size_t count) {
+        if constexpr (WIDE) codes.assign(table.size(), {});
+        else codes.fill({});
+        if (root < 0) return;
+        if (nodes[root].left < 0) {
+            codes[table.index(static_cast<TableSymbol>(nodes[root].ch))] = {0, 1};
+            return;
+        }
+        struct Frame {
+            int node;
+            huffman::Code code;
+        };
+        Storage<Frame, MAX_NODES> stack;
+        if constexpr (WIDE) stack.resize(count);
+        std::size_t top = 0;
+        stack[top++] = {root, {}};
+        while (top > 0) {
+            Frame f = stack[--top];
+            const Node& node = nodes[f.node];
+            if (node.left < 0) {
+                codes[table.index(static_cast<TableSymbol>(node.ch))] = f.code;
+                continue;
+            }
+            if (f.code.length == MAX_DEPTH) throw std::length_error("huffman: tree deeper than 64 levels");
+            auto length = static_cast<std::uint8_t>(f.code.length + 1);
+            stack[top++] = {node.right, {(f.code.bits << 1) | 1, length}};
+            stack[top++] = {node.left, {f.code.bits << 1, length}};
+        }
+    }
+    
+    /*
+     * freqs[i] 为 sorted[i] 的出现次数, sorted 为空时为符号 i 的出现次数。叶子按频率升序放在数组开头,
+     * 合并出的内部节点依次追加在后面, 它们的频率也是非递减的, 于是两段各自就是一个有序队列,
+     * 每次从两个队首取较小者, 不需要优先队列。字节符号的整个过程没有堆内存分配。
+     */
+    void build(std::span<const std::uint64_t> freqs, std::span<const TableSymbol> sorted) {
+        table.build(freqs, sorted);
+        table.buildDecoder();
+        
+        Storage<std::uint32_t, huffman::ALPHABET_SIZE> order;
+        if constexpr (WIDE) order.resize(freqs.size());
+        std::size_t n = huffman::detail::sortByFrequency(freqs, order);
+        if constexpr (WIDE) nodes.assign(n == 0 ? 0 : 2 * n - 1, {});
+        for (std::size_t i = 0; i < n; ++i) {
+            TableSymbol s = sorted.empty() ? static_cast<TableSymbol>(order[i]) : sorted[order[i]];
+            nodes[i] = {static_cast<Symbol>(s), freqs[order[i]], -1, -1};
+        }
+        
+        std::size_t leaf = 0;       // 下一个未合并的叶子
+        std::size_t inner = n;      // 下一个未合并的内部节点
+        std::size_t count = n;      // 已用的节点数
+        auto takeMin = [&]() -> Index {
+            if (inner < count && (leaf >= n || nodes[inner].freq < nodes[leaf].freq)) return static_cast<Index>(inner++);
+            return static_cast<Index>(leaf++);
+        };
+        // 每次取出频率最小的两个节点, 合并为一个新节点
+        for (std::size_t merges = 1; merges < n; ++merges) {
+            Index left = takeMin();
+            Index right = takeMin();
+            nodes[count++] = {Symbol{}, nodes[left].freq + nodes[right].freq, left, right};
+        }
+        root = n == 0 ? -1 : static_cast<int>(count - 1);
+        
+        // 构建Huffman编码
+        buildCodes(count);
+    }
+
+public:
+    HuffmanTree() = default;
+    
+    // 构建Huffman树
+    void buildTree(const std::unordered_map<Symbol, int>& freqMap) {
+        if constexpr (WIDE) {
+            buildTree(huffman::symbolHistogram(freqMap));
+        }
+        else {
+            huffman::Histogram freqs{};
+            for (const auto& pair : freqMap) freqs[static_cast<TableSymbol>(pair.first)] = static_cast<std::uint64_t>(pair.second);
+            buildTree(freqs);
+        }
+    }
+    
+    // 由字节直方图构建, 见 huffman::histogram
+    void buildTree(const huffman::Histogram& freqs) {
+        static_assert(!WIDE, "huffman: use a SymbolHistogram for multi-byte symbols");
+        build(freqs, {});
+    }
+    
+    // 由多字节符号的频率构建, 见 huffman::symbolHistogram
+    void buildTree(const huffman::SymbolHistogram<TableSymbol>& freqs) {
+        build(freqs.counts, freqs.symbols);
+    }
+    
+    // 获取Huffman编码
+    std::unordered_map<Symbol, std::string> getCodes() const {
+        std::unordered_map<Symbol, std::string> result;
+        for (std::size_t s = 0; s < codes.size(); ++s) {
+            if (codes[s].length == 0) continue;
+            std::string code(codes[s].length, '0');
+            for (std::size_t i = 0; i < code.size(); ++i) {
+                if ((codes[s].bits >> (code.size() - 1 - i)) & 1) code[i] = '1';
+            }
+            result[static_cast<Symbol>(table.symbol(s))] = code;
+        }
+        return result;
+    }
+    
+    // 打印Huffman编码, 非 char 的符号打印为整数
+    void printCodes() const {
+        std::cout << "Huffman Codes:" << std::endl;
+        for (const auto& pair : getCodes()) {
+            if constexpr (std::is_same_v<Symbol, char>) std::cout << pair.first;
+            else std::cout << static_cast<std::uint64_t>(pair.first);
+            std::cout << ": " << pair.second << std::endl;
+        }
+    }
+    
+    // 编码, 每一位输出一个 '0' 或 '1'
+    std::string encode(const Sequence& text) const {
+        std::size_t bits = 0;
+        for (Symbol ch : text) {
+            const huffman::Code& c = codeOf(ch);
+            if (c.length == 0) throw std::out_of_range("huffman: symbol not in code table");
+            bits += c.length;
+        }
+        std::string encoded(bits, '0');
+        std::size_t pos = 0;
+        for (Symbol ch : text) {
+            const huffman::Code& c = codeOf(ch);
+            for (unsigned i = c.length; i-- > 0;) encoded[pos++] = static_cast<char>('0' + ((c.bits >> i) & 1));
+        }
+        return encoded;
+    }
+    
+    // 解码
+    Sequence decode(const std::string& encoded) const {
+        Sequence decoded{};
+        if (root < 0) return decoded;
+        int current = root;
+        
+        for (char bit : encoded) {
+            if (nodes[current].left >= 0) {
+                current = bit == '0' ? nodes[current].left : nodes[current].right;
+            }
+            
+            // 到达叶子节点
+            if (nodes[current].left < 0) {
+                decoded.push_back(nodes[current].ch);
+                current = root;
+            }
+        }
+        
+        return decoded;
+    }
+    
+    // 用范式编码打包为比特流
+    huffman::PackedBits encodePacked(const Sequence& text) const {
+        return table.encode(reinterpret_cast<const TableSymbol*>(text.data()), text.size());
+    }
+    
+    // 查表解码打包的比特流
+    Sequence decodePacked(const huffman::PackedBits& packed) const {
+        Sequence decoded(packed.symbols, Symbol{});
+        table.decode(packed, decoded.data());
+        return decoded;
+    }
+    
+    // 压缩为自描述的块: 码长表 + 比特流, 解码端不需要这棵树
+    std::vector<std::uint8_t> compress(const Sequence& text) const {
+        std::vector<std::uint8_t> out;
+        huffman::writeBlock(table, {reinterpret_cast<const TableSymbol*>(text.data()), text.size()}, out);
+        return out;
+    }
+    
+    static Sequence decompress(std::span<const std::uint8_t> data) {
+        std::vector<TableSymbol> out;
+        huffman::readBlock(data, out);
+        if constexpr (std::is_same_v<Sequence, std::vector<TableSymbol>>) return out;
+        else return Sequence(out.begin(), out.end());
+    }
+};
+
+// 计算字符频率。大量数据请使用 huffman::histogram, 它用数组计数, 并且可以多线程
+inline std::unordered_map<char, int> calculateFrequency(const std::string& text) {
+    std::unordered_map<char, int> freqMap;
+    for (char ch : text) {
+        freqMap[ch]++;
+    }
+    return freqMap;
+}
+
+// 计算多字节符号的频率。大量数据请使用 huffman::symbolHistogram
+template<typename Symbol>
+std::unordered_map<Symbol, int> calculateFrequency(const std::vector<Symbol>& symbols) {
+    std::unordered_map<Symbol, int> freqMap;
+    for (Symbol s : symbols) {
+        freqMap[s]++;
+    }
+    return freqMap;
+}
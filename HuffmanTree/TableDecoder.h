@@ -0,0 +1,223 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "./BitStream.h"
+
+
+namespace huffman {
+    // 一个符号的码字: 右对齐存放在 bits 的低 length 位, length 为 0 表示该符号不出现
+    struct Code {
+        std::uint64_t bits = 0;
+        std::uint8_t length = 0;
+    };
+
+
+    /*
+     * 查表解码。一级表以比特流的前 ROOT_BITS 位为下标, 码长不超过 ROOT_BITS 的码字占据
+     * 2^(ROOT_BITS - 码长) 个连续表项, 查一次表就得到符号和码长; 更长的码字按前缀分组,
+     * 一级表项指向各组的子表, 子表再以之后的若干位为下标, 必要时继续分级。
+     * Huffman 编码中长码字出现的概率很低, 绝大多数符号只需要一次查表。
+     *
+     * 表项是一个 32 位整数: 低 5 位为长度, 第 5 位为子表标记, 高 24 位为符号(稀疏码表中是符号的序号)或子表的起始下标。
+     * 叶子表项的长度是本级需要消耗的比特数; 子表表项的长度是子表的下标位数。
+     */
+    class TableDecoder {
+    public:
+        static constexpr std::uint32_t MAX_VALUE = (std::uint32_t{1} << 24) - 1;  // 表项中符号和下标的上限
+        static constexpr unsigned ROOT_BITS = 11;       // 一级表的默认位数, 8KB, 放得进 L1
+        static constexpr unsigned MAX_ROOT_BITS = 14;   // 一次装填解码 4 个符号, 4 * 14 <= 56
+
+    private:
+        static constexpr unsigned SUB_BITS = 8;
+        static constexpr std::uint32_t LENGTH_MASK = 31;
+        static constexpr std::uint32_t LINK = 1u << 5;
+        static constexpr unsigned VALUE_SHIFT = 8;
+
+        struct Item {
+            std::uint64_t aligned;      // 左对齐的码字
+            std::uint32_t symbol;
+            unsigned length;
+        };
+
+        std::vector<std::uint32_t> table;
+        std::vector<Item> scratch;      // 构建时的临时数组, 保留容量供下次构建复用
+        unsigned root_bits = 0;
+
+
+        static std::size_t indexAt(const Item& item, unsigned consumed, unsigned bits) {
+            return static_cast<std::size_t>((item.aligned << consumed) >> (64 - bits));
+        }
+
+        /*
+         * 填写从 offset 开始的一张表。items 按码字排序, 前 consumed 位相同, 表的下标是之后的 bits 位;
+         * 剩余长度不超过 bits 的码字直接填入, 其余按下标分组, 每组建立一张子表。
+         */
+        void fill(std::size_t offset, unsigned bits, unsigned consumed, std::span<const Item> items) {
+            std::size_t i = 0;
+            while (i < items.size()) {
+                const Item& item = items[i];
+                unsigned rest = item.length - consumed;
+                std::size_t index = indexAt(item, consumed, bits);
+                if (rest <= bits) {
+                    std::uint32_t entry = (item.symbol << VALUE_SHIFT) | rest;
+                    std::fill_n(table.begin() + static_cast<std::ptrdiff_t>(offset + index), std::size_t{1} << (bits - rest), entry);
+                    ++i;
+                    continue;
+                }
+                std::size_t j = i;
+                unsigned longest = 0;
+                while (j < items.size() && items[j].length - consumed > bits && indexAt(items[j], consumed, bits) == index) {
+                    longest = std::max(longest, items[j].length);
+                    ++j;
+                }
+                unsigned sub_bits = std::min(longest - consumed - bits, SUB_BITS);
+                std::size_t sub = table.size();
+                table.resize(sub + (std::size_t{1} << sub_bits), 0);
+                if (table.size() > MAX_VALUE) throw std::length_error("huffman: decode table too large");
+                table[offset + index] = static_cast<std::uint32_t>(sub << VALUE_SHIFT) | LINK | sub_bits;
+                fill(sub, sub_bits, consumed + bits, items.subspan(i, j - i));
+                i = j;
+            }
+        }
+
+
+        // 一级表没有命中叶子: 逐级进入子表, 返回叶子表项; 结束时重新装满缓冲区
+        std::uint32_t follow(BitReader& reader, std::uint32_t entry, std::uint64_t& consumed) const {
+            unsigned bits = root_bits;
+            while (entry & LINK) {
+                reader.consume(bits);
+                consumed += bits;
+                reader.refill();
+                bits = entry & LENGTH_MASK;
+                entry = table[(entry >> VALUE_SHIFT) + reader.peek(bits)];
+            }
+            return entry;
+        }
+
+        /*
+         * 解码一个符号, 调用前缓冲区中至少有一级表的位数。
+         * 每个符号都要经过这里, 强制内联: 翻译单元很大时 GCC 会因 inline-unit-growth 放弃内联,
+         * 交错解码的 4 个读取器随之被迫放回内存。
+         */
+        template<typename Symbol>
+        [[gnu::always_inline]] Symbol next(BitReader& reader, std::uint64_t& consumed) const {
+            std::uint32_t entry = table[reader.peek(root_bits)];
+            if (entry & LINK) [[unlikely]] entry = follow(reader, entry, consumed);
+            unsigned length = entry & LENGTH_MASK;
+            reader.consume(length);
+            consumed += length;
+            return static_cast<Symbol>(entry >> VALUE_SHIFT);
+        }
+
+    public:
+        static constexpr unsigned STREAMS = 4;      // 交错解码的比特流条数
+
+        TableDecoder() = default;
+
+        explicit TableDecoder(std::span<const Code> codes, unsigned rootBits = ROOT_BITS) {
+            build(codes, rootBits);
+        }
+
+
+        /*
+         * codes[s] 为符号 s 的码字, 必须构成前缀码。重新构建时复用已有的内存。
+         * 码字多、较长时(多字节符号)加大一级表可以减少进入子表的次数, rootBits 不超过 MAX_ROOT_BITS。
+         */
+        void build(std::span<const Code> codes, unsigned rootBits = ROOT_BITS) {
+            if (rootBits == 0 || rootBits > MAX_ROOT_BITS) throw std::invalid_argument("huffman: bad root table size");
+            if (codes.size() > std::size_t{MAX_VALUE} + 1) throw std::length_error("huffman: alphabet too large");
+            scratch.clear();
+            unsigned longest = 0;
+            for (std::size_t s = 0; s < codes.size(); ++s) {
+                if (codes[s].length == 0) continue;
+                scratch.push_back({codes[s].bits << (64 - codes[s].length), static_cast<std::uint32_t>(s), codes[s].length});
+                longest = std::max<unsigned>(longest, codes[s].length);
+            }
+            std::sort(scratch.begin(), scratch.end(), [](const Item& a, const Item& b) { return a.aligned < b.aligned; });
+
+            table.clear();
+            root_bits = std::min(longest, rootBits);
+            if (scratch.empty()) return;
+            table.assign(std::size_t{1} << root_bits, 0);
+            fill(0, root_bits, 0, scratch);
+        }
+
+
+        /*
+         * 从 reader 的当前位置解码 n 个符号写入 out, consumed 累加消耗的比特数。
+         * 每次装满缓冲区后连续解码 4 个符号, 一级表命中时每个符号只有一次查表、一次移位。
+         * 可以分多次调用, 中间更换码表(自适应模式)。
+         */
+        template<typename Symbol>
+        void decode(BitReader& reader, Symbol* out, std::uint64_t n, std::uint64_t& consumed) const {
+            if (n == 0) return;
+            if (table.empty()) throw std::invalid_argument("huffman: empty code table");
+
+            std::uint64_t i = 0;
+            // 4 * MAX_ROOT_BITS <= 56, 一次装填足够解码 4 个符号
+            for (; i + 4 <= n; i += 4) {
+                reader.refill();
+                out[i] = next<Symbol>(reader, consumed);
+                out[i + 1] = next<Symbol>(reader, consumed);
+                out[i + 2] = next<Symbol>(reader, consumed);
+                out[i + 3] = next<Symbol>(reader, consumed);
+            }
+            for (; i < n; ++i) {
+                reader.refill();
+                out[i] = next<Symbol>(reader, consumed);
+            }
+        }
+
+        /*
+         * 交错解码 STREAMS 条独立的比特流, 第 k 条解码 n[k] 个符号写入 out[k], consumed[k] 累加它消耗的比特数。
+         * 单条比特流中每个符号的查表要等上一个符号的码长算出之后才能开始, 解码受限于这条依赖链的延迟;
+         * 每轮依次从各条流解码一个符号, 4 条依赖链互不相关, CPU 可以同时执行, 查表的延迟互相掩盖。
+         */
+        template<typename Symbol>
+        void decodeInterleaved(std::array<BitReader, STREAMS>& readers, const std::array<Symbol*, STREAMS>& out,
+                               const std::array<std::uint64_t, STREAMS>& n, std::array<std::uint64_t, STREAMS>& consumed) const {
+            std::uint64_t common = std::min({n[0], n[1], n[2], n[3]});
+            std::uint64_t i = 0;
+            if (common >= 4 && table.empty()) throw std::invalid_argument("huffman: empty code table");
+            // 复制到局部变量, 让编译器把 4 个读取器都放在寄存器中
+            BitReader r0 = readers[0], r1 = readers[1], r2 = readers[2], r3 = readers[3];
+            std::uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+            for (; i + 4 <= common; i += 4) {
+                r0.refill();
+                r1.refill();
+                r2.refill();
+                r3.refill();
+                for (unsigned j = 0; j < 4; ++j) {
+                    out[0][i + j] = next<Symbol>(r0, c0);
+                    out[1][i + j] = next<Symbol>(r1, c1);
+                    out[2][i + j] = next<Symbol>(r2, c2);
+                    out[3][i + j] = next<Symbol>(r3, c3);
+                }
+            }
+            readers = {r0, r1, r2, r3};
+            consumed[0] += c0;
+            consumed[1] += c1;
+            consumed[2] += c2;
+            consumed[3] += c3;
+            for (unsigned k = 0; k < STREAMS; ++k) decode(readers[k], out[k] + i, n[k] - i, consumed[k]);
+        }
+
+        // 解码 in.symbols 个符号写入 out。消耗的比特数与 in.bits 不符时抛出 invalid_argument
+        template<typename Symbol>
+        void decode(const PackedBits& in, Symbol* out) const {
+            BitReader reader(in.bytes.data(), in.bytes.size());
+            std::uint64_t consumed = 0;
+            decode(reader, out, in.symbols, consumed);
+            if (consumed != in.bits) throw std::invalid_argument("huffman: corrupt bit stream");
+        }
+
+
+        std::size_t memoryUsage() const { return table.capacity() * sizeof(std::uint32_t); }
+    };
+
+} // namespace huffman
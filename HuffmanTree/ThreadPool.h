@@ -0,0 +1,79 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace huffman {
+    /*
+     * 固定线程数的线程池。任务放在一个加锁的队列里, 按提交顺序开始执行;
+     * submit 返回 future, 任务抛出的异常在 get 时重新抛出。析构时执行完已提交的任务再退出。
+     */
+    class ThreadPool {
+    private:
+        std::vector<std::thread> workers;
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable ready;
+        bool stopping = false;
+
+        void run() {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ready.wait(lock, [this] { return stopping || !tasks.empty(); });
+                    if (tasks.empty()) return;
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                task();
+            }
+        }
+
+    public:
+        explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency()) {
+            if (threads == 0) threads = 1;
+            workers.reserve(threads);
+            for (std::size_t i = 0; i < threads; ++i) workers.emplace_back([this] { run(); });
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            ready.notify_all();
+            for (auto& worker : workers) worker.join();
+        }
+
+
+        template<typename F>
+        std::future<std::invoke_result_t<F&>> submit(F&& f) {
+            using R = std::invoke_result_t<F&>;
+            // std::function 要求可复制, packaged_task 只能移动, 用 shared_ptr 包一层
+            auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+            std::future<R> result = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.emplace_back([task] { (*task)(); });
+            }
+            ready.notify_one();
+            return result;
+        }
+
+        std::size_t size() const { return workers.size(); }
+    };
+
+} // namespace huffman
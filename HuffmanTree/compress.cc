@@ -0,0 +1,109 @@
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include "BlockCompressor.h"
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+
+/*
+ * 用法: compress [-d] [-b KB] [-t N] <input> <output>
+ *   -d      解压, 默认压缩
+ *   -b KB   块大小, 默认 128, 范围 1 到 65536
+ *   -t N    线程数, 默认为 CPU 核数, 范围 1 到 1024
+ * 文件名为 - 时使用标准输入 / 标准输出。统计信息输出到标准错误。
+ */
+namespace {
+    void usage() {
+        std::cerr << "usage: compress [-d] [-b KB] [-t N] <input> <output>\n";
+    }
+
+    // 解析 1 到 max 之间的十进制整数, 整个参数都必须是数字
+    bool parseCount(const char* text, std::size_t max, std::size_t& value) {
+        const char* end = text + std::char_traits<char>::length(text);
+        auto [ptr, ec] = std::from_chars(text, end, value);
+        return ec == std::errc() && ptr == end && value >= 1 && value <= max;
+    }
+}
+
+
+int main(int argc, char const* argv[]) {
+    bool decompress = false;
+    huffman::BlockOptions options;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-d") decompress = true;
+        else if ((arg == "-b" || arg == "-t") && i + 1 < argc) {
+            // 块大小的上限同时保证 value << 10 不会溢出; 线程数超过上限时报错, 而不是创建上万个线程
+            std::size_t max = arg == "-b" ? huffman::MAX_BLOCK_SIZE >> 10 : huffman::MAX_THREADS;
+            std::size_t value = 0;
+            if (!parseCount(argv[++i], max, value)) {
+                std::cerr << "invalid value for " << arg << ": " << argv[i] << "\n";
+                usage();
+                return 2;
+            }
+            if (arg == "-b") options.block_size = value << 10;
+            else options.threads = value;
+        }
+        else if (arg.size() > 1 && arg[0] == '-') {
+            usage();
+            return 2;
+        }
+        else files.push_back(arg);
+    }
+    if (files.size() != 2) {
+        usage();
+        return 2;
+    }
+
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    std::ios::sync_with_stdio(false);
+    std::ifstream input_file;
+    std::ofstream output_file;
+    if (files[0] != "-") {
+        input_file.open(files[0], std::ios::binary);
+        if (!input_file) {
+            std::cerr << "cannot open " << files[0] << "\n";
+            return 1;
+        }
+    }
+    if (files[1] != "-") {
+        output_file.open(files[1], std::ios::binary | std::ios::trunc);
+        if (!output_file) {
+            std::cerr << "cannot create " << files[1] << "\n";
+            return 1;
+        }
+    }
+    std::istream& in = files[0] == "-" ? std::cin : input_file;
+    std::ostream& out = files[1] == "-" ? std::cout : output_file;
+
+    try {
+        auto start = std::chrono::steady_clock::now();
+        huffman::StreamStats stats = decompress ? huffman::decompressStream(in, out, options.threads)
+                                                : huffman::compressStream(in, out, options);
+        out.flush();
+        if (!out) throw std::runtime_error("huffman: write error");
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::uint64_t plain = decompress ? stats.bytes_out : stats.bytes_in;
+        std::fprintf(stderr, "%llu -> %llu bytes, %llu blocks, ratio %.3f, %.1f MB/s\n",
+                     static_cast<unsigned long long>(stats.bytes_in), static_cast<unsigned long long>(stats.bytes_out),
+                     static_cast<unsigned long long>(stats.blocks),
+                     plain ? static_cast<double>(decompress ? stats.bytes_in : stats.bytes_out) / static_cast<double>(plain) : 0.0,
+                     seconds > 0 ? static_cast<double>(plain) / seconds / 1e6 : 0.0);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
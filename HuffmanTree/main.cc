@@ -1,147 +1,7 @@
-#include <iostream>
-#include <queue>
-#include <vector>
-#include <string>
-#include <unordered_map>
+#include "Adaptive.h"
+#include "HuffmanTree.h"
 using namespace std;
 
-// Huffman树节点
-struct HuffmanNode {
-    char ch;           // 字符
-    int freq;          // 频率
-    HuffmanNode* left; // 左孩子
-    HuffmanNode* right;// 右孩子
-    
-    HuffmanNode(char c, int f) : ch(c), freq(f), left(nullptr), right(nullptr) {}
-    HuffmanNode(int f) : ch('\0'), freq(f), left(nullptr), right(nullptr) {}
-};
-
-// 用于优先队列的比较函数
-struct Compare {
-    bool operator()(HuffmanNode* a, HuffmanNode* b) {
-        return a->freq > b->freq; // 最小堆
-    }
-};
-
-class HuffmanTree {
-private:
-    HuffmanNode* root;
-    unordered_map<char, string> huffmanCodes;
-    
-    // 构建Huffman编码
-    void buildCodes(HuffmanNode* node, string code) {
-        if (!node) return;
-        
-        // 叶子节点，存储编码
-        if (!node->left && !node->right) {
-            huffmanCodes[node->ch] = code;
-            return;
-        }
-        
-        buildCodes(node->left, code + "0");
-        buildCodes(node->right, code + "1");
-    }
-    
-    // 删除树
-    void deleteTree(HuffmanNode* node) {
-        if (!node) return;
-        deleteTree(node->left);
-        deleteTree(node->right);
-        delete node;
-    }
-
-public:
-    HuffmanTree() : root(nullptr) {}
-    
-    ~HuffmanTree() {
-        deleteTree(root);
-    }
-    
-    // 构建Huffman树
-    void buildTree(const unordered_map<char, int>& freqMap) {
-        // 最小堆优先队列
-        priority_queue<HuffmanNode*, vector<HuffmanNode*>, Compare> pq;
-        
-        // 为每个字符创建节点并加入优先队列
-        for (const auto& pair : freqMap) {
-            pq.push(new HuffmanNode(pair.first, pair.second));
-        }
-        
-        // 构建Huffman树
-        while (pq.size() > 1) {
-            // 取出频率最小的两个节点
-            HuffmanNode* left = pq.top(); pq.pop();
-            HuffmanNode* right = pq.top(); pq.pop();
-            
-            // 创建新节点，频率为两个子节点频率之和
-            HuffmanNode* parent = new HuffmanNode(left->freq + right->freq);
-            parent->left = left;
-            parent->right = right;
-            
-            pq.push(parent);
-        }
-        
-        root = pq.top();
-        pq.pop();
-        
-        // 构建Huffman编码
-        buildCodes(root, "");
-    }
-    
-    // 获取Huffman编码
-    unordered_map<char, string> getCodes() const {
-        return huffmanCodes;
-    }
-    
-    // 打印Huffman编码
-    void printCodes() const {
-        cout << "Huffman Codes:" << endl;
-        for (const auto& pair : huffmanCodes) {
-            cout << pair.first << ": " << pair.second << endl;
-        }
-    }
-    
-    // 编码字符串
-    string encode(const string& text) {
-        string encoded = "";
-        for (char ch : text) {
-            encoded += huffmanCodes.at(ch);
-        }
-        return encoded;
-    }
-    
-    // 解码
-    string decode(const string& encoded) {
-        string decoded = "";
-        HuffmanNode* current = root;
-        
-        for (char bit : encoded) {
-            if (bit == '0') {
-                current = current->left;
-            } else {
-                current = current->right;
-            }
-            
-            // 到达叶子节点
-            if (!current->left && !current->right) {
-                decoded += current->ch;
-                current = root;
-            }
-        }
-        
-        return decoded;
-    }
-};
-
-// 计算字符频率
-unordered_map<char, int> calculateFrequency(const string& text) {
-    unordered_map<char, int> freqMap;
-    for (char ch : text) {
-        freqMap[ch]++;
-    }
-    return freqMap;
-}
-
 int main() {
     string text = "hello world";
     
@@ -163,5 +23,33 @@ int main() {
     string decoded = huffmanTree.decode(encoded);
     cout << "Decoded: " << decoded << endl;
     
+    // 打包为比特流, 查表解码
+    auto packed = huffmanTree.encodePacked(text);
+    cout << "Packed: " << packed.bits << " bits in " << packed.bytes.size() << " bytes" << endl;
+    cout << "Table decoded: " << huffmanTree.decodePacked(packed) << endl;
+    
+    // 压缩: 只需保存码长表, 解压时不需要原来的树
+    auto compressed = huffmanTree.compress(text);
+    cout << "Compressed: " << compressed.size() << " bytes, decompressed: " << HuffmanTree<>::decompress(compressed) << endl;
+    
+    // 自适应模式: 不需要事先统计频率, 边写边编码, 解码端可以按任意片段输入
+    huffman::AdaptiveEncoder adaptiveEncoder;
+    vector<uint8_t> stream;
+    adaptiveEncoder.write({reinterpret_cast<const uint8_t*>(text.data()), text.size()}, stream);
+    adaptiveEncoder.flush(stream);
+    huffman::AdaptiveDecoder adaptiveDecoder;
+    vector<uint8_t> restored;
+    for (uint8_t byte : stream) adaptiveDecoder.feed({&byte, 1}, restored);
+    cout << "Adaptive: " << stream.size() << " bytes, decoded: " << string(restored.begin(), restored.end()) << endl;
+    
+    // 以 16 位词元为符号建树, 同样可以压缩
+    vector<uint16_t> tokens = {7, 512, 512, 40000, 7, 7, 512, 1000};
+    HuffmanTree<uint16_t> tokenTree;
+    tokenTree.buildTree(calculateFrequency(tokens));
+    tokenTree.printCodes();
+    auto tokenBlock = tokenTree.compress(tokens);
+    cout << "Tokens: " << tokenBlock.size() << " bytes, round trip "
+         << (HuffmanTree<uint16_t>::decompress(tokenBlock) == tokens ? "ok" : "failed") << endl;
+    
     return 0;
 }
\ No newline at end of file
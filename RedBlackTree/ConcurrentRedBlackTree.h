@@ -0,0 +1,232 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
+#include "RedBlackTree.h"
+
+/*
+ * 线程安全的红黑树, 读多写少时读操作可以并行且不互相阻塞。
+ *
+ * 写操作持有写锁, 并在修改前后各把版本号 seq 加一(修改期间为奇数)。
+ * 读操作先做乐观读取: 不加锁, 记下版本号后沿树下降, 结束时版本号未变才说明读到的是一致的结果,
+ * 否则重试; 连续失败 MAX_OPTIMISTIC 次后改为持有读锁读取, 避免写入频繁时读操作饿死。
+ *
+ * 乐观读取可能读到正在被修改的节点甚至已删除的节点, 依赖以下几点保证安全:
+ *   1. 节点来自 NodePool, 删除的节点只进入空闲链表, 内存在树析构前不会归还系统,
+ *      任何时刻读到的孩子指针都指向池中的节点、nil 或 nullptr; clear 也逐个删除而不释放内存块。
+ *      nullptr 来自刚构造、还没有挂上 nil 的节点(新分配或复用的槽位), 读到时放弃本次读取
+ *   2. 指针按 atomic_ref 读取; key 与元素先按字节复制到局部变量, 校验版本号之后才使用元素副本,
+ *      因此要求元素可平凡复制, 否则 find 总是加读锁
+ *   3. 比较发生在校验之前, 撕裂的 key 副本必须可以安全地比较: 只有算术类型和枚举的 key 走乐观读取,
+ *      string_view、const char* 这类带指针的 key 比较时会解引用垃圾指针, 总是加读锁。
+ *      其他不含指针的 key(例如由整数组成的结构体)可以特化 OptimisticKey 开启
+ *   4. 下降的步数超过红黑树可能的最大高度时放弃本次读取, 防止读到写了一半的指针而成环
+ * 写操作本身仍是普通的存储, 与乐观读取之间按 C++ 内存模型属于数据竞争(seqlock 的通常做法),
+ * 竞争的读取结果总会被版本号校验丢弃。
+ */
+template <typename Key>
+struct OptimisticKey : std::bool_constant<std::is_arithmetic_v<Key> || std::is_enum_v<Key>> {};
+
+template <typename T, typename Compare = std::less<>, typename KeyOf = Identity>
+class ConcurrentRedBlackTree {
+public:
+    using Tree = RedBlackTree<T, NodePool, NoAugment, Compare, KeyOf>;
+    using NodeType = typename Tree::NodeType;
+    using key_type = typename Tree::key_type;
+    using value_type = T;
+
+    static constexpr int MAX_OPTIMISTIC = 8;
+    // 红黑树的高度不超过 2 * log2(n + 1), 64 位地址空间内不超过 128
+    static constexpr int MAX_DEPTH = 128;
+
+private:
+    static constexpr bool optimistic_keys = OptimisticKey<key_type>::value && std::is_trivially_copyable_v<key_type>;
+    static constexpr bool optimistic_values = std::is_trivially_copyable_v<T>;
+
+    Tree tree;
+    [[no_unique_address]] Compare comp;
+    [[no_unique_address]] KeyOf key_of;
+    mutable std::shared_mutex rw_mutex;
+    alignas(64) std::atomic<std::uint64_t> seq{0};
+    alignas(64) mutable std::atomic<std::uint64_t> retry_count{0};      // 版本号校验失败的次数
+    mutable std::atomic<std::uint64_t> fallback_count{0};               // 改为加读锁的次数
+
+
+    // 写操作: 持有写锁, 修改期间版本号为奇数
+    template <typename F>
+    auto write(F&& f) {
+        std::unique_lock<std::shared_mutex> lock(rw_mutex);
+        seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        struct Publish {
+            std::atomic<std::uint64_t>& seq;
+            ~Publish() { seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+        } publish{seq};
+        return f(tree);
+    }
+
+
+    static NodeType* loadLink(NodeType* const& link) {
+        return std::atomic_ref<NodeType*>(const_cast<NodeType*&>(link)).load(std::memory_order_relaxed);
+    }
+
+    // 按字节复制可能正在被修改的对象, 结果在版本号校验通过后才可信
+    template <typename U>
+    static U loadRacy(const U& obj) {
+        alignas(U) unsigned char buf[sizeof(U)];
+        std::memcpy(buf, static_cast<const void*>(&obj), sizeof(U));
+        return std::bit_cast<U>(buf);
+    }
+
+
+    /*
+     * 不加锁地查找 key, 找到时 on_hit(node) 从节点中取出结果。
+     * 返回值: 版本号校验失败时为 nullopt(需要重试), 否则为 (是否找到)。
+     */
+    template <typename Q, typename Hit>
+    std::optional<bool> tryOptimistic(const Q& key, Hit&& on_hit) const {
+        std::uint64_t before = seq.load(std::memory_order_acquire);
+        if (before & 1) return std::nullopt;
+
+        bool found = false;
+        bool complete = false;
+        NodeType* current = loadLink(tree.rootSlot());
+        for (int depth = 0; depth < MAX_DEPTH; ++depth) {
+            if (current == nullptr) break;      // 节点正在构造, 版本号必然已经改变
+            if (tree.isNil(current)) {
+                complete = true;
+                break;
+            }
+            key_type k = loadRacy(key_of(current->data));
+            if (comp(key, k)) {
+                current = loadLink(current->left);
+            }
+            else if (comp(k, key)) {
+                current = loadLink(current->right);
+            }
+            else {
+                on_hit(current);
+                found = complete = true;
+                break;
+            }
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!complete || seq.load(std::memory_order_relaxed) != before) return std::nullopt;
+        return found;
+    }
+
+
+    // 先乐观读取, 多次失败后加读锁; locked(tree) 是加锁时的读取方式
+    template <typename Q, typename Hit, typename Locked>
+    bool read(const Q& key, Hit&& on_hit, Locked&& locked) const {
+        for (int attempt = 0; attempt < MAX_OPTIMISTIC; ++attempt) {
+            if (auto result = tryOptimistic(key, on_hit)) return *result;
+            retry_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        fallback_count.fetch_add(1, std::memory_order_relaxed);
+        std::shared_lock<std::shared_mutex> lock(rw_mutex);
+        return locked(tree);
+    }
+
+
+public:
+    explicit ConcurrentRedBlackTree(const Compare& c = Compare()) : tree(c), comp(c) {}
+
+    ConcurrentRedBlackTree(const ConcurrentRedBlackTree&) = delete;
+    ConcurrentRedBlackTree& operator=(const ConcurrentRedBlackTree&) = delete;
+
+
+    // 插入元素, key 已存在时返回 false
+    bool insert(const T& val) {
+        return write([&](Tree& t) { return t.emplaceUnique(val).second; });
+    }
+
+    template <typename... Args>
+    bool emplace(Args&&... args) {
+        return write([&](Tree& t) { return t.emplaceUnique(std::forward<Args>(args)...).second; });
+    }
+
+    template <typename Q>
+    bool erase(const Q& key) {
+        return write([&](Tree& t) { return t.remove(key); });
+    }
+
+
+    template <typename Q>
+    bool contains(const Q& key) const {
+        if constexpr (optimistic_keys) {
+            return read(key, [](NodeType*) {}, [&](const Tree& t) { return !t.isNil(t.search(key)); });
+        }
+        else {
+            std::shared_lock<std::shared_mutex> lock(rw_mutex);
+            return !tree.isNil(tree.search(key));
+        }
+    }
+
+
+    // 返回元素的副本; 元素不可平凡复制时只能加读锁复制
+    template <typename Q>
+    std::optional<T> find(const Q& key) const {
+        if constexpr (optimistic_keys && optimistic_values) {
+            std::optional<T> result;
+            // 每次乐观读取都覆盖 result, 只有最后一次校验通过的结果会被返回
+            bool found = read(
+                key, [&](NodeType* node) { result.emplace(loadRacy(node->data)); },
+                [&](const Tree& t) {
+                    result.reset();
+                    NodeType* node = t.search(key);
+                    if (t.isNil(node)) return false;
+                    result.emplace(node->data);
+                    return true;
+                });
+            if (!found) result.reset();
+            return result;
+        }
+        else {
+            std::shared_lock<std::shared_mutex> lock(rw_mutex);
+            NodeType* node = tree.search(key);
+            if (tree.isNil(node)) return std::nullopt;
+            return node->data;
+        }
+    }
+
+
+    // 持有读锁按升序遍历, 回调中不能修改本树
+    template <typename F>
+    void forEach(F&& callback) const {
+        std::shared_lock<std::shared_mutex> lock(rw_mutex);
+        for (const auto& item : tree) callback(item);
+    }
+
+
+    std::size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(rw_mutex);
+        return tree.size();
+    }
+
+    // 逐个删除, 节点内存留在池中, 保证并发的乐观读取不会访问已释放的内存
+    void clear() {
+        write([](Tree& t) {
+            while (!t.empty()) t.erase(t.begin());
+            return 0;
+        });
+    }
+
+    std::size_t memoryUsage() const {
+        std::shared_lock<std::shared_mutex> lock(rw_mutex);
+        return tree.memoryUsage();
+    }
+
+    // 乐观读取因版本号变化而重试的次数, 以及最终改为加读锁的次数
+    std::uint64_t retries() const { return retry_count.load(std::memory_order_relaxed); }
+    std::uint64_t fallbacks() const { return fallback_count.load(std::memory_order_relaxed); }
+};
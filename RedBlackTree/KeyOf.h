@@ -0,0 +1,13 @@
+#pragma once
+
+// 从元素中取出用于比较的 key: 集合直接使用元素本身, 映射使用 pair 的 first
+// RedBlackTree 与 btree::BPlusTree 共用这两个类型, 同一个 KeyOf 可以在两者之间互换
+struct Identity {
+    template <typename U>
+    const U& operator()(const U& v) const { return v; }
+};
+
+struct SelectFirst {
+    template <typename P>
+    const auto& operator()(const P& p) const { return p.first; }
+};
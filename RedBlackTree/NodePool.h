@@ -0,0 +1,131 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+/*
+ * 红黑树的节点分配器, 作为 RedBlackTree 的模板参数 Alloc 使用, 需要提供:
+ *   create(args...)        构造一个节点并返回指针
+ *   destroy(node)          析构节点并回收其内存
+ *   merge(other)           接管 other 分配的所有节点, 用于把另一棵树的节点并入本树
+ *   bulk_release           为 true 时分配器析构(或 reset)会一次性释放所有节点的内存,
+ *                          树销毁时只需调用节点的析构函数, T 可平凡析构时连遍历都可以省去
+ */
+
+
+// 节点池: 从大块内存中连续切分节点, 删除的节点进入空闲链表供下次插入复用; 不是线程安全的
+template <typename NodeT>
+class NodePool {
+private:
+    static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+    static constexpr std::size_t ALIGN = alignof(NodeT) > alignof(void*) ? alignof(NodeT) : alignof(void*);
+    // 空闲的槽位首部存放下一个空闲槽位的指针
+    static constexpr std::size_t SLOT_SIZE =
+        ((sizeof(NodeT) > sizeof(void*) ? sizeof(NodeT) : sizeof(void*)) + ALIGN - 1) & ~(ALIGN - 1);
+    static constexpr std::size_t SLOTS_PER_BLOCK = BLOCK_SIZE / SLOT_SIZE > 0 ? BLOCK_SIZE / SLOT_SIZE : 1;
+
+    std::vector<char*> blocks;
+    char* cursor = nullptr;         // 当前块中下一个未使用的槽位
+    char* block_end = nullptr;
+    void* free_list = nullptr;
+
+
+    void* allocate() {
+        if (free_list) {
+            void* p = free_list;
+            free_list = *static_cast<void**>(p);
+            return p;
+        }
+        if (cursor == block_end) {
+            char* block = static_cast<char*>(::operator new(SLOTS_PER_BLOCK * SLOT_SIZE, std::align_val_t(ALIGN)));
+            blocks.push_back(block);
+            cursor = block;
+            block_end = block + SLOTS_PER_BLOCK * SLOT_SIZE;
+        }
+        void* p = cursor;
+        cursor += SLOT_SIZE;
+        return p;
+    }
+
+
+public:
+    static constexpr bool bulk_release = true;
+
+    NodePool() = default;
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() { reset(); }
+
+
+    template <typename... Args>
+    NodeT* create(Args&&... args) {
+        void* p = allocate();
+        return new (p) NodeT(std::forward<Args>(args)...);
+    }
+
+
+    void destroy(NodeT* node) {
+        node->~NodeT();
+        void* p = node;
+        *static_cast<void**>(p) = free_list;
+        free_list = p;
+    }
+
+
+    // 释放所有内存块, 代价与块数成正比; 调用者需保证已不再使用任何节点(析构函数不会被调用)
+    void reset() {
+        for (char* block : blocks) ::operator delete(block, std::align_val_t(ALIGN));
+        blocks.clear();
+        cursor = block_end = nullptr;
+        free_list = nullptr;
+    }
+
+
+    /*
+     * 接管 other 的所有内存块, 之后 other 为空; other 中仍存活的节点从此属于本池。
+     * other 当前块里尚未切分的槽位和空闲链表一并并入本池的空闲链表。
+     */
+    void merge(NodePool& other) {
+        if (this == &other) return;
+        blocks.insert(blocks.end(), other.blocks.begin(), other.blocks.end());
+        for (char* p = other.cursor; p != other.block_end; p += SLOT_SIZE) {
+            *reinterpret_cast<void**>(p) = free_list;
+            free_list = p;
+        }
+        if (other.free_list) {
+            void* tail = other.free_list;
+            while (*static_cast<void**>(tail)) tail = *static_cast<void**>(tail);
+            *static_cast<void**>(tail) = free_list;
+            free_list = other.free_list;
+        }
+        other.blocks.clear();
+        other.cursor = other.block_end = nullptr;
+        other.free_list = nullptr;
+    }
+
+
+    // 向系统申请的总字节数
+    std::size_t memoryUsage() const { return blocks.size() * SLOTS_PER_BLOCK * SLOT_SIZE; }
+};
+
+
+// 逐个 new / delete 的分配器, 即原来的做法, 用于对比
+template <typename NodeT>
+class HeapAllocator {
+public:
+    static constexpr bool bulk_release = false;
+
+    template <typename... Args>
+    NodeT* create(Args&&... args) { return new NodeT(std::forward<Args>(args)...); }
+
+    void destroy(NodeT* node) { delete node; }
+
+    void reset() {}
+
+    // 节点各自独立分配, 不需要转移任何东西
+    void merge(HeapAllocator&) {}
+
+    std::size_t memoryUsage() const { return 0; }
+};
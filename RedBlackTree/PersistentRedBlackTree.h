@@ -0,0 +1,333 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "RedBlackTree.h"
+
+/*
+ * 持久化(不可变)红黑树: 每次修改都返回一个新版本, 旧版本保持不变且仍然可用。
+ * 修改只复制从根到修改位置的路径(O(log n) 个节点), 其余子树由新旧版本共享,
+ * 节点用 shared_ptr 引用计数, 最后一个引用它的版本销毁时释放。
+ * 节点不能有父指针(同一个节点可能属于多个版本), 插入采用 Okasaki 的做法, 删除采用 Kahrs 的做法,
+ * 都是自顶向下递归重建路径, 不需要回溯。
+ * 版本对象本身只是一个根指针, 复制它就是 O(1) 的快照。
+ */
+template <typename T>
+struct PersistentNode {
+    using Ptr = std::shared_ptr<const PersistentNode>;
+
+    T data;
+    Color color;
+    Ptr left, right;
+    std::size_t size;  // 子树中的节点数
+
+    PersistentNode(Color c, Ptr l, const T& val, Ptr r)
+        : data(val), color(c), left(std::move(l)), right(std::move(r)),
+          size(1 + (left ? left->size : 0) + (right ? right->size : 0)) {}
+};
+
+
+template <typename T, typename Compare = std::less<>, typename KeyOf = Identity>
+class VersionedRedBlackTree;
+
+
+template <typename T, typename Compare = std::less<>, typename KeyOf = Identity>
+class PersistentRedBlackTree {
+public:
+    using NodeType = PersistentNode<T>;
+    using NodePtr = typename NodeType::Ptr;
+    using key_type = std::remove_cvref_t<std::invoke_result_t<const KeyOf&, const T&>>;
+    using value_type = T;
+    using size_type = std::size_t;
+
+private:
+    friend class VersionedRedBlackTree<T, Compare, KeyOf>;
+
+    NodePtr root;
+    [[no_unique_address]] Compare comp;
+    [[no_unique_address]] KeyOf key_of;
+
+    PersistentRedBlackTree(NodePtr r, const Compare& c) : root(std::move(r)), comp(c) {}
+
+    const key_type& keyOf(const NodePtr& node) const { return key_of(node->data); }
+
+    static NodePtr make(Color c, NodePtr l, const T& val, NodePtr r) {
+        return std::make_shared<const NodeType>(c, std::move(l), val, std::move(r));
+    }
+
+    static bool isRed(const NodePtr& node) { return node && node->color == RED; }
+    static bool isBlack(const NodePtr& node) { return node && node->color == BLACK; }
+
+    static NodePtr blacken(const NodePtr& node) {
+        if (!isRed(node)) return node;
+        return make(BLACK, node->left, node->data, node->right);
+    }
+
+    // 把子树的根染红, 只用于删除时降低黑高, 根必须是黑的
+    static NodePtr redden(const NodePtr& node) {
+        assert(isBlack(node) && "PersistentRedBlackTree: 红黑性质被破坏");
+        return make(RED, node->left, node->data, node->right);
+    }
+
+    /*
+     * 以 y 为根重新组合 l 与 r, 消除孩子与孙子之间的连续红节点(红孩子上移并染黑两侧)。
+     * 比 Okasaki 原版多一种两个孩子都是红色的情况, 删除时需要。
+     */
+    static NodePtr balance(const NodePtr& l, const T& y, const NodePtr& r) {
+        if (isRed(l) && isRed(r)) {
+            return make(RED, blacken(l), y, blacken(r));
+        }
+        if (isRed(l) && isRed(l->left)) {
+            return make(RED, blacken(l->left), l->data, make(BLACK, l->right, y, r));
+        }
+        if (isRed(l) && isRed(l->right)) {
+            return make(RED, make(BLACK, l->left, l->data, l->right->left), l->right->data,
+                        make(BLACK, l->right->right, y, r));
+        }
+        if (isRed(r) && isRed(r->right)) {
+            return make(RED, make(BLACK, l, y, r->left), r->data, blacken(r->right));
+        }
+        if (isRed(r) && isRed(r->left)) {
+            return make(RED, make(BLACK, l, y, r->left->left), r->left->data,
+                        make(BLACK, r->left->right, r->data, r->right));
+        }
+        return make(BLACK, l, y, r);
+    }
+
+
+    // 插入: 只在黑节点处调用 balance, 红节点直接复制; replace 为 true 时替换 key 相同的元素
+    NodePtr ins(const NodePtr& node, const T& val, bool replace) const {
+        if (!node) return make(RED, nullptr, val, nullptr);
+        const key_type& key = key_of(val);
+        if (comp(key, keyOf(node))) {
+            NodePtr l = ins(node->left, val, replace);
+            if (l == node->left) return node;
+            return node->color == BLACK ? balance(l, node->data, node->right) : make(RED, l, node->data, node->right);
+        }
+        if (comp(keyOf(node), key)) {
+            NodePtr r = ins(node->right, val, replace);
+            if (r == node->right) return node;
+            return node->color == BLACK ? balance(node->left, node->data, r) : make(RED, node->left, node->data, r);
+        }
+        return replace ? make(node->color, node->left, val, node->right) : node;
+    }
+
+
+    /*
+     * Kahrs 的删除: 从黑节点的一侧删除会使该侧黑高减一, 由 balLeft / balRight 借助另一侧恢复;
+     * 删除的节点由 fuse 把它的两个孩子拼接起来。
+     */
+    static NodePtr balLeft(const NodePtr& l, const T& x, const NodePtr& r) {
+        if (isRed(l)) return make(RED, blacken(l), x, r);
+        if (isBlack(r)) return balance(l, x, redden(r));
+        assert(isRed(r) && isBlack(r->left) && "PersistentRedBlackTree: 红黑性质被破坏");
+        return make(RED, make(BLACK, l, x, r->left->left), r->left->data,
+                    balance(r->left->right, r->data, redden(r->right)));
+    }
+
+    static NodePtr balRight(const NodePtr& l, const T& x, const NodePtr& r) {
+        if (isRed(r)) return make(RED, l, x, blacken(r));
+        if (isBlack(l)) return balance(redden(l), x, r);
+        assert(isRed(l) && isBlack(l->right) && "PersistentRedBlackTree: 红黑性质被破坏");
+        return make(RED, balance(redden(l->left), l->data, l->right->left), l->right->data,
+                    make(BLACK, l->right->right, x, r));
+    }
+
+    // 拼接被删除节点的左右子树, a 中的 key 都小于 b 中的
+    static NodePtr fuse(const NodePtr& a, const NodePtr& b) {
+        if (!a) return b;
+        if (!b) return a;
+        if (isRed(a) && isRed(b)) {
+            NodePtr bc = fuse(a->right, b->left);
+            if (isRed(bc)) {
+                return make(RED, make(RED, a->left, a->data, bc->left), bc->data, make(RED, bc->right, b->data, b->right));
+            }
+            return make(RED, a->left, a->data, make(RED, bc, b->data, b->right));
+        }
+        if (isBlack(a) && isBlack(b)) {
+            NodePtr bc = fuse(a->right, b->left);
+            if (isRed(bc)) {
+                return make(RED, make(BLACK, a->left, a->data, bc->left), bc->data,
+                            make(BLACK, bc->right, b->data, b->right));
+            }
+            return balLeft(a->left, a->data, make(BLACK, bc, b->data, b->right));
+        }
+        if (isRed(b)) return make(RED, fuse(a, b->left), b->data, b->right);
+        return make(RED, a->left, a->data, fuse(a->right, b));
+    }
+
+    // 调用者保证 key 存在, 否则黑高的推理不成立
+    template <typename Q>
+    NodePtr del(const NodePtr& node, const Q& key) const {
+        if (comp(key, keyOf(node))) {
+            if (isBlack(node->left)) return balLeft(del(node->left, key), node->data, node->right);
+            return make(RED, del(node->left, key), node->data, node->right);
+        }
+        if (comp(keyOf(node), key)) {
+            if (isBlack(node->right)) return balRight(node->left, node->data, del(node->right, key));
+            return make(RED, node->left, node->data, del(node->right, key));
+        }
+        return fuse(node->left, node->right);
+    }
+
+    template <typename Q>
+    const NodeType* findNode(const Q& key) const {
+        const NodeType* node = root.get();
+        while (node) {
+            if (comp(key, key_of(node->data))) node = node->left.get();
+            else if (comp(key_of(node->data), key)) node = node->right.get();
+            else return node;
+        }
+        return nullptr;
+    }
+
+public:
+    /*
+     * 中序只读迭代器。没有父指针, 用栈记录从根到当前节点的路径上尚未访问的祖先;
+     * 迭代器不持有版本, 使用期间该版本必须存活。
+     */
+    class const_iterator {
+    private:
+        friend class PersistentRedBlackTree;
+        std::vector<const NodeType*> stack;
+
+        void pushLeft(const NodeType* node) {
+            for (; node; node = node->left.get()) stack.push_back(node);
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = const T&;
+        using pointer = const T*;
+
+        const_iterator() = default;
+
+        reference operator*() const { return stack.back()->data; }
+        pointer operator->() const { return &stack.back()->data; }
+
+        const_iterator& operator++() {
+            const NodeType* node = stack.back();
+            stack.pop_back();
+            pushLeft(node->right.get());
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            if (stack.empty() || other.stack.empty()) return stack.empty() == other.stack.empty();
+            return stack.back() == other.stack.back();
+        }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+    };
+
+    using iterator = const_iterator;
+
+
+    explicit PersistentRedBlackTree(const Compare& c = Compare()) : comp(c) {}
+
+
+    // 返回插入 val 后的新版本; key 已存在时返回与本版本相同的树
+    [[nodiscard]] PersistentRedBlackTree insert(const T& val) const {
+        return PersistentRedBlackTree(blacken(ins(root, val, false)), comp);
+    }
+
+    // 返回插入或替换 val 后的新版本
+    [[nodiscard]] PersistentRedBlackTree insertOrAssign(const T& val) const {
+        return PersistentRedBlackTree(blacken(ins(root, val, true)), comp);
+    }
+
+    // 返回删除 key 后的新版本; key 不存在时返回与本版本相同的树
+    template <typename Q>
+    [[nodiscard]] PersistentRedBlackTree remove(const Q& key) const {
+        if (!findNode(key)) return *this;
+        return PersistentRedBlackTree(blacken(del(root, key)), comp);
+    }
+
+
+    // 返回的指针在本版本(或共享该节点的任一版本)存活期间有效
+    template <typename Q>
+    const T* find(const Q& key) const {
+        const NodeType* node = findNode(key);
+        return node ? &node->data : nullptr;
+    }
+
+    template <typename Q>
+    bool contains(const Q& key) const { return findNode(key) != nullptr; }
+
+    const_iterator begin() const {
+        const_iterator it;
+        it.pushLeft(root.get());
+        return it;
+    }
+
+    const_iterator end() const { return const_iterator(); }
+
+    std::size_t size() const { return root ? root->size : 0; }
+    bool empty() const { return !root; }
+
+    // 两个版本是否共享同一个根, 用于判断修改是否真的发生
+    bool sameVersion(const PersistentRedBlackTree& other) const { return root == other.root; }
+};
+
+
+/*
+ * 持有最新版本的容器: 写操作在互斥锁内基于当前版本生成新版本并原子地发布,
+ * 读操作调用 snapshot() 原子地取得当前版本, 之后在快照上的查找与遍历不加任何锁,
+ * 不受之后写入的影响。快照的代价是一次引用计数加一, 多个读者共用一个快照时可以只取一次。
+ */
+template <typename T, typename Compare, typename KeyOf>
+class VersionedRedBlackTree {
+public:
+    using Version = PersistentRedBlackTree<T, Compare, KeyOf>;
+
+private:
+    std::atomic<typename Version::NodePtr> current;
+    std::mutex write_mutex;
+    [[no_unique_address]] Compare comp;
+
+    template <typename F>
+    bool update(F&& f) {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        Version before(current.load(std::memory_order_acquire), comp);
+        Version after = f(before);
+        if (after.sameVersion(before)) return false;
+        current.store(std::move(after.root), std::memory_order_release);
+        return true;
+    }
+
+public:
+    explicit VersionedRedBlackTree(const Compare& c = Compare()) : comp(c) {}
+
+    VersionedRedBlackTree(const VersionedRedBlackTree&) = delete;
+    VersionedRedBlackTree& operator=(const VersionedRedBlackTree&) = delete;
+
+    // O(1) 的一致快照
+    Version snapshot() const { return Version(current.load(std::memory_order_acquire), comp); }
+
+    // 以下写操作返回是否产生了新版本
+    bool insert(const T& val) {
+        return update([&](const Version& v) { return v.insert(val); });
+    }
+
+    bool insertOrAssign(const T& val) {
+        return update([&](const Version& v) { return v.insertOrAssign(val); });
+    }
+
+    template <typename Q>
+    bool remove(const Q& key) {
+        return update([&](const Version& v) { return v.remove(key); });
+    }
+};
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include "RedBlackTree.h"
+
+/*
+ * 基于红黑树的有序映射, 接口与 std::map 的常用部分一致, key 唯一。
+ * 默认比较器 std::less<> 是透明的: 例如 key 为 std::string 时可以直接用 std::string_view 或
+ * 字符串字面量查找, 不会构造临时 std::string。
+ */
+template <typename K, typename V, typename Compare = std::less<>, template <typename> class Alloc = NodePool>
+class RedBlackMap {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+
+private:
+    using Tree = RedBlackTree<value_type, Alloc, NoAugment, Compare, SelectFirst>;
+    Tree tree;
+
+public:
+    using iterator = typename Tree::iterator;
+    using const_iterator = typename Tree::const_iterator;
+
+    RedBlackMap() = default;
+    explicit RedBlackMap(const Compare& comp) : tree(comp) {}
+
+    RedBlackMap(std::initializer_list<value_type> items) {
+        for (const auto& item : items) tree.emplaceUnique(item);
+    }
+
+    // 用 args 构造元素后插入, key 已存在时丢弃新元素
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) { return tree.emplaceUnique(std::forward<Args>(args)...); }
+
+    std::pair<iterator, bool> insert(const value_type& item) { return tree.tryEmplace(item.first, item); }
+    std::pair<iterator, bool> insert(value_type&& item) { return tree.tryEmplace(item.first, std::move(item)); }
+
+    // key 不存在时才用 args 原地构造 value, 存在时 args 不会被移动
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+        return tree.tryEmplace(key, std::piecewise_construct, std::forward_as_tuple(key),
+                               std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        return tree.tryEmplace(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                               std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    // 不存在时插入默认构造的 value
+    V& operator[](const K& key) { return try_emplace(key).first->second; }
+    V& operator[](K&& key) { return try_emplace(std::move(key)).first->second; }
+
+    template <typename Q>
+    V& at(const Q& key) {
+        auto it = tree.find(key);
+        if (it == tree.end()) throw std::out_of_range("RedBlackMap::at: key 不存在");
+        return it->second;
+    }
+
+    template <typename Q>
+    const V& at(const Q& key) const {
+        auto it = tree.find(key);
+        if (it == tree.end()) throw std::out_of_range("RedBlackMap::at: key 不存在");
+        return it->second;
+    }
+
+    template <typename Q>
+    iterator find(const Q& key) { return tree.find(key); }
+    template <typename Q>
+    const_iterator find(const Q& key) const { return tree.find(key); }
+
+    template <typename Q>
+    bool contains(const Q& key) const { return tree.find(key) != tree.end(); }
+    template <typename Q>
+    size_type count(const Q& key) const { return contains(key) ? 1 : 0; }
+
+    template <typename Q>
+    iterator lower_bound(const Q& key) { return tree.lower_bound(key); }
+    template <typename Q>
+    const_iterator lower_bound(const Q& key) const { return tree.lower_bound(key); }
+
+    template <typename Q>
+    iterator upper_bound(const Q& key) { return tree.upper_bound(key); }
+    template <typename Q>
+    const_iterator upper_bound(const Q& key) const { return tree.upper_bound(key); }
+
+    template <typename Q>
+    std::pair<iterator, iterator> equal_range(const Q& key) { return tree.equal_range(key); }
+    template <typename Q>
+    std::pair<const_iterator, const_iterator> equal_range(const Q& key) const { return tree.equal_range(key); }
+
+    iterator erase(const_iterator pos) { return tree.erase(pos); }
+    iterator erase(iterator pos) { return tree.erase(pos); }
+
+    // 返回删除的元素个数(0 或 1); 排除迭代器类型, 避免与按位置删除产生歧义
+    template <typename Q>
+        requires(!std::is_convertible_v<const Q&, const_iterator>)
+    size_type erase(const Q& key) { return tree.remove(key) ? 1 : 0; }
+
+    iterator begin() { return tree.begin(); }
+    iterator end() { return tree.end(); }
+    const_iterator begin() const { return tree.begin(); }
+    const_iterator end() const { return tree.end(); }
+    const_iterator cbegin() const { return tree.cbegin(); }
+    const_iterator cend() const { return tree.cend(); }
+
+    size_type size() const { return tree.size(); }
+    bool empty() const { return tree.empty(); }
+    void clear() { tree.clear(); }
+
+    std::size_t memoryUsage() const { return tree.memoryUsage(); }
+};
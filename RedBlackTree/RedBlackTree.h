@@ -1,27 +1,93 @@
+#pragma once
 #include <iostream>
 #include <cassert>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "KeyOf.h"
+#include "NodePool.h"
 
 enum Color { RED, BLACK };
 
-template <typename T>
+/*
+ * 节点增强策略: 在每个节点上维护由子树决定的附加信息(例如区间树中子树的最大右端点)。
+ * 需要提供:
+ *   value_type             附加信息的类型, 存放在 node->aug
+ *   update(node, nil)      由 node->data 与左右孩子的 aug 重新计算 node->aug, 孩子可能是哨兵 nil
+ * 树在旋转、插入、删除改变子树结构时按自底向上的顺序调用 update。
+ */
+struct NoAugment {
+    struct value_type {};
+
+    template <typename NodeT>
+    static void update(NodeT*, const NodeT*) {}
+};
+
+template <typename T, typename Augment = NoAugment>
 struct Node {
     T data;
     Color color;
     Node *left, *right, *parent;
+    std::size_t size;  // 以该节点为根的子树中的节点数, 哨兵为0
+    [[no_unique_address]] typename Augment::value_type aug;
 
     // 构造函数(默认红色，符合插入规则)
-    Node(const T& val) : data(val), color(RED), left(nullptr), right(nullptr), parent(nullptr) {}
+    Node(const T& val) : data(val), color(RED), left(nullptr), right(nullptr), parent(nullptr), size(1), aug() {}
+
+    // 用 args 原地构造元素
+    template <typename... Args>
+    Node(std::in_place_t, Args&&... args)
+        : data(std::forward<Args>(args)...), color(RED), left(nullptr), right(nullptr), parent(nullptr), size(1), aug() {}
 };
 
-template <typename T>
+/*
+ * Alloc: 节点分配器(见 NodePool.h), 默认使用节点池,
+ * HeapAllocator 为逐个 new / delete 的原始做法
+ * Augment: 节点增强策略, 子树大小总是维护的, 用于 select / rank
+ * Compare: 比较 key 的函数对象, 默认 std::less<> 是透明的, 查找时可以直接传入与 key 可比较的其他类型
+ * KeyOf:   从元素中取出 key, RedBlackMap 使用 SelectFirst
+ */
+template <typename T, template <typename> class Alloc = NodePool, typename Augment = NoAugment,
+          typename Compare = std::less<>, typename KeyOf = Identity>
 class RedBlackTree {
+public:
+    using NodeType = Node<T, Augment>;
+    using key_type = std::remove_cvref_t<std::invoke_result_t<const KeyOf&, const T&>>;
+    using value_type = T;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+
 private:
-    Node<T>* root;
-    Node<T>* nil;  // 哨兵节点(所有叶节点的替代，简化边界处理)
+    Alloc<NodeType> alloc;  // 必须先于 nil 构造、后于所有节点销毁
+    NodeType* root;
+    NodeType* nil;  // 哨兵节点(所有叶节点的替代，简化边界处理)
+    [[no_unique_address]] Compare comp;
+    [[no_unique_address]] KeyOf key_of;
+
+    const key_type& keyOf(const NodeType* node) const { return key_of(node->data); }
+
+    // 由左右孩子重新计算 node 的子树大小和增强信息, node 不能是哨兵
+    void pull(NodeType* node) {
+        node->size = node->left->size + node->right->size + 1;
+        Augment::update(node, static_cast<const NodeType*>(nil));
+    }
+
+    static constexpr bool augmented = !std::is_same_v<Augment, NoAugment>;
+
+    // 从 node 一直更新到根, 用于插入或删除改变了一条路径之后
+    void pullPath(NodeType* node) {
+        for (; node != nil; node = node->parent) pull(node);
+    }
 
     // 左旋转
-    void leftRotate(Node<T>* x) {
-        Node<T>* y = x->right;
+    void leftRotate(NodeType* x) {
+        NodeType* y = x->right;
         x->right = y->left;
 
         if (y->left != nil) {
@@ -40,11 +106,15 @@ private:
         }
         y->left = x;
         x->parent = y;
+
+        // x 成为 y 的孩子, 先更新 x 再更新 y
+        pull(x);
+        pull(y);
     }
 
     // 右旋转
-    void rightRotate(Node<T>* y) {
-        Node<T>* x = y->left;
+    void rightRotate(NodeType* y) {
+        NodeType* x = y->left;
         y->left = x->right;
 
         if (x->right != nil) {
@@ -63,13 +133,16 @@ private:
         }
         x->right = y;
         y->parent = x;
+
+        pull(y);
+        pull(x);
     }
 
     // 插入后修复红黑树性质
-    void insertFixup(Node<T>* z) {
+    void insertFixup(NodeType* z) {
         while (z->parent->color == RED) {  // 父节点为红才可能违反规则
             if (z->parent == z->parent->parent->left) {
-                Node<T>* y = z->parent->parent->right;  // 叔节点
+                NodeType* y = z->parent->parent->right;  // 叔节点
 
                 if (y->color == RED) {
                     // 情况1：叔节点为红(父、叔变黑, 祖父变红, 继续向上检查)
@@ -92,7 +165,7 @@ private:
             } 
             else {
                 // 对称情况(父节点是右孩子)
-                Node<T>* y = z->parent->parent->left;  // 叔节点
+                NodeType* y = z->parent->parent->left;  // 叔节点
 
                 if (y->color == RED) {
                     z->parent->color = BLACK;
@@ -115,15 +188,179 @@ private:
     }
 
     // 查找最小值节点
-    Node<T>* minimum(Node<T>* node) {
+    NodeType* minimum(NodeType* node) const {
         while (node->left != nil) {
             node = node->left;
         }
         return node;
     }
 
+    NodeType* maximum(NodeType* node) const {
+        while (node->right != nil) {
+            node = node->right;
+        }
+        return node;
+    }
+
+    // 中序后继与前驱, 没有时返回 nil
+    NodeType* successor(NodeType* node) const {
+        if (node->right != nil) return minimum(node->right);
+        NodeType* p = node->parent;
+        while (p != nil && node == p->right) {
+            node = p;
+            p = p->parent;
+        }
+        return p;
+    }
+
+    NodeType* predecessor(NodeType* node) const {
+        if (node->left != nil) return maximum(node->left);
+        NodeType* p = node->parent;
+        while (p != nil && node == p->left) {
+            node = p;
+            p = p->parent;
+        }
+        return p;
+    }
+
+    // 第一个 key 不小于 key 的节点
+    template <typename Q>
+    NodeType* lowerBoundNode(const Q& key) const {
+        NodeType* result = nil;
+        NodeType* current = root;
+        while (current != nil) {
+            if (comp(keyOf(current), key)) {
+                current = current->right;
+            }
+            else {
+                result = current;
+                current = current->left;
+            }
+        }
+        return result;
+    }
+
+    // 第一个 key 大于 key 的节点
+    template <typename Q>
+    NodeType* upperBoundNode(const Q& key) const {
+        NodeType* result = nil;
+        NodeType* current = root;
+        while (current != nil) {
+            if (comp(key, keyOf(current))) {
+                result = current;
+                current = current->left;
+            }
+            else {
+                current = current->right;
+            }
+        }
+        return result;
+    }
+
+    // 把新节点 z 挂到 parent 下(parent 为 nil 表示空树), 调用者负责路径上的子树大小
+    void attach(NodeType* z, NodeType* parent) {
+        z->parent = parent;
+        if (parent == nil) {
+            root = z;  // 树为空，z成为根
+        }
+        else if (comp(keyOf(z), keyOf(parent))) {
+            parent->left = z;
+        }
+        else {
+            parent->right = z;
+        }
+
+        z->left = nil;
+        z->right = nil;
+        z->color = RED;  // 新节点默认红色
+    }
+
+    /*
+     * 为 key 查找插入位置: 已存在时返回 (该节点, true), 否则返回 (新节点的父节点, false)。
+     * 不修改树, 子树大小在确定插入后由 link 更新。
+     */
+    template <typename Q>
+    std::pair<NodeType*, bool> findSlot(const Q& key) const {
+        NodeType* parent = nil;
+        NodeType* current = root;
+        while (current != nil) {
+            parent = current;
+            if (comp(key, keyOf(current))) {
+                current = current->left;
+            }
+            else if (comp(keyOf(current), key)) {
+                current = current->right;
+            }
+            else {
+                return {current, true};
+            }
+        }
+        return {parent, false};
+    }
+
+    // 把新节点挂到 findSlot 给出的位置并恢复红黑性质
+    void link(NodeType* z, NodeType* parent) {
+        attach(z, parent);
+        if constexpr (augmented) {
+            pullPath(z);
+        }
+        else {
+            for (NodeType* p = parent; p != nil; p = p->parent) ++p->size;
+        }
+        insertFixup(z);
+    }
+
+    // 从树中摘除节点 z 并释放
+    void eraseNode(NodeType* z) {
+        NodeType* y = z;
+        NodeType* x;
+        Color yOriginalColor = y->color;
+
+        if (z->left == nil) {
+            x = z->right;
+            transplant(z, z->right);
+        } 
+        else if (z->right == nil) {
+            x = z->left;
+            transplant(z, z->left);
+        } 
+        else {
+            y = minimum(z->right);  // 找后继节点
+            yOriginalColor = y->color;
+            x = y->right;
+
+            if (y->parent == z) {
+                x->parent = y;
+            } 
+            else {
+                transplant(y, y->right);
+                y->right = z->right;
+                y->right->parent = y;
+            }
+            transplant(z, y);
+            y->left = z->left;
+            y->left->parent = y;
+            y->color = z->color;
+            y->size = z->size;
+        }
+
+        alloc.destroy(z);  // 节点内存归还给分配器
+
+        // x 的父节点是结构发生变化的最低位置(y 被移走时也经过 y 的新位置), 由此向上更新
+        if constexpr (augmented) {
+            pullPath(x->parent);
+        }
+        else {
+            for (NodeType* p = x->parent; p != nil; p = p->parent) --p->size;
+        }
+
+        if (yOriginalColor == BLACK) {
+            deleteFixup(x);  // 只有删除黑节点才需要修复
+        }
+    }
+
     // 替换子节点(用于删除操作)
-    void transplant(Node<T>* u, Node<T>* v) {
+    void transplant(NodeType* u, NodeType* v) {
         if (u->parent == nil) {
             root = v;
         } 
@@ -137,10 +374,10 @@ private:
     }
 
     // 删除后修复红黑树性质
-    void deleteFixup(Node<T>* x) {
+    void deleteFixup(NodeType* x) {
         while (x != root && x->color == BLACK) {
             if (x == x->parent->left) {
-                Node<T>* w = x->parent->right;  // 兄弟节点
+                NodeType* w = x->parent->right;  // 兄弟节点
 
                 if (w->color == RED) {
                     // 情况1：兄弟为红(转为兄弟为黑的情况)
@@ -173,7 +410,7 @@ private:
             } 
             else {
                 // 对称情况(x是右孩子)
-                Node<T>* w = x->parent->left;
+                NodeType* w = x->parent->left;
 
                 if (w->color == RED) {
                     w->color = BLACK;
@@ -204,17 +441,321 @@ private:
         x->color = BLACK;  // 确保x为黑
     }
 
-    // 递归删除节点(析构时使用)
-    void destroy(Node<T>* node) {
-        if (node != nil) {
-            destroy(node->left);
-            destroy(node->right);
-            delete node;
+    /*
+     * 销毁以 node 为根的子树(析构和 clear 时使用)。
+     * 不用递归: 有左孩子就右旋把它提上来, 没有左孩子时释放当前节点并走向右孩子, O(n) 且不占栈。
+     * 分配器可以整体释放内存时只需要调用析构函数, T 可平凡析构时直接跳过遍历。
+     */
+    void destroy(NodeType* node) {
+        if constexpr (Alloc<NodeType>::bulk_release && std::is_trivially_destructible_v<T>) {
+            return;
         }
+        while (node != nil) {
+            if (node->left != nil) {
+                NodeType* l = node->left;
+                node->left = l->right;
+                l->right = node;
+                node = l;
+            }
+            else {
+                NodeType* next = node->right;
+                if constexpr (Alloc<NodeType>::bulk_release) node->~NodeType();
+                else alloc.destroy(node);
+                node = next;
+            }
+        }
+    }
+
+
+    NodeType* createNil() {
+        NodeType* n = alloc.create(std::in_place);
+        n->color = BLACK;  // 哨兵节点为黑
+        n->size = 0;
+        n->left = n->right = n->parent = n;  // 哨兵自循环
+        return n;
+    }
+
+    /*
+     * 基于 join 的批量操作(Blelloch 等, "Just Join for Parallel Ordered Sets")。
+     * 这些函数操作脱离了树的子树: 子树用 (根, 黑高) 表示, 黑高为从根到叶子路径上的黑节点数(含根, 不含 nil),
+     * 孩子的黑高由父节点直接推出, 因此 join 的代价只与两侧黑高之差有关, 不需要在节点上额外存储。
+     * 子树根的 parent 由把它挂上去的调用者设置, 最终的根由 adoptRoot 设置。
+     */
+    struct Subtree {
+        NodeType* node;
+        int bh;
+    };
+
+    struct Split {
+        Subtree less;
+        NodeType* match;  // 与 key 相等的节点, 没有时为 nullptr
+        Subtree greater;
+    };
+
+    static constexpr std::size_t PARALLEL_CUTOFF = 1 << 14;  // 两侧合计小于该节点数时不再分叉
+
+    int childBh(const NodeType* node, int bh) const { return bh - (node->color == BLACK ? 1 : 0); }
+
+    // 整棵树的黑高, 沿最左路径计数
+    int blackHeight(NodeType* node) const {
+        int bh = 0;
+        for (; node != nil; node = node->left) {
+            if (node->color == BLACK) ++bh;
+        }
+        return bh;
+    }
+
+    // k 的左右孩子设为 l, r 并重新计算子树信息
+    NodeType* makeNode(NodeType* l, NodeType* k, NodeType* r, Color c) {
+        k->left = l;
+        k->right = r;
+        if (l != nil) l->parent = k;
+        if (r != nil) r->parent = k;
+        k->color = c;
+        pull(k);
+        return k;
+    }
+
+    NodeType* rotateLeftDetached(NodeType* x) {
+        NodeType* y = x->right;
+        makeNode(x->left, x, y->left, x->color);
+        return makeNode(x, y, y->right, y->color);
+    }
+
+    NodeType* rotateRightDetached(NodeType* y) {
+        NodeType* x = y->left;
+        makeNode(x->right, y, y->right, y->color);
+        return makeNode(x->left, x, y, x->color);
+    }
+
+    // l 的黑高大于 r: 沿 l 的右侧下降到黑高与 r 相同的黑节点处挂上 k, 回溯时消除连续的红节点
+    NodeType* joinRight(Subtree l, NodeType* k, Subtree r) {
+        if (l.node->color == BLACK && l.bh == r.bh) return makeNode(l.node, k, r.node, RED);
+        NodeType* t = l.node;
+        NodeType* sub = joinRight({t->right, childBh(t, l.bh)}, k, r);
+        makeNode(t->left, t, sub, t->color);
+        if (t->color == BLACK && sub->color == RED && sub->right->color == RED) {
+            sub->right->color = BLACK;
+            return rotateLeftDetached(t);
+        }
+        return t;
+    }
+
+    NodeType* joinLeft(Subtree l, NodeType* k, Subtree r) {
+        if (r.node->color == BLACK && r.bh == l.bh) return makeNode(l.node, k, r.node, RED);
+        NodeType* t = r.node;
+        NodeType* sub = joinLeft(l, k, {t->left, childBh(t, r.bh)});
+        makeNode(sub, t, t->right, t->color);
+        if (t->color == BLACK && sub->color == RED && sub->left->color == RED) {
+            sub->left->color = BLACK;
+            return rotateRightDetached(t);
+        }
+        return t;
+    }
+
+    // 以 k 为分隔合并两棵子树, 要求 l 中的 key 都小于 k, r 中的都大于 k; O(|l.bh - r.bh| + 1)
+    Subtree join(Subtree l, NodeType* k, Subtree r) {
+        if (l.bh > r.bh) {
+            NodeType* t = joinRight(l, k, r);
+            if (t->color == RED && t->right->color == RED) {
+                t->color = BLACK;
+                return {t, l.bh + 1};
+            }
+            return {t, l.bh};
+        }
+        if (r.bh > l.bh) {
+            NodeType* t = joinLeft(l, k, r);
+            if (t->color == RED && t->left->color == RED) {
+                t->color = BLACK;
+                return {t, r.bh + 1};
+            }
+            return {t, r.bh};
+        }
+        if (l.node->color == BLACK && r.node->color == BLACK) return {makeNode(l.node, k, r.node, RED), l.bh};
+        return {makeNode(l.node, k, r.node, BLACK), l.bh + 1};
+    }
+
+    // 摘下子树中最大的节点, 返回 (剩余部分, 该节点)
+    std::pair<Subtree, NodeType*> splitLast(Subtree t) {
+        NodeType* node = t.node;
+        int hc = childBh(node, t.bh);
+        if (node->right == nil) return {{node->left, hc}, node};
+        auto [rest, last] = splitLast({node->right, hc});
+        return {join({node->left, hc}, node, rest), last};
+    }
+
+    // 没有分隔节点的合并, 要求 l 中的 key 都小于 r 中的
+    Subtree join2(Subtree l, Subtree r) {
+        if (l.node == nil) return r;
+        if (r.node == nil) return l;
+        auto [rest, last] = splitLast(l);
+        return join(rest, last, r);
+    }
+
+    // 按 key 把子树分成小于、等于、大于三部分; O(log n)
+    template <typename Q>
+    Split split(Subtree t, const Q& key) {
+        if (t.node == nil) return {{nil, 0}, nullptr, {nil, 0}};
+        NodeType* node = t.node;
+        int hc = childBh(node, t.bh);
+        if (comp(key, keyOf(node))) {
+            Split s = split({node->left, hc}, key);
+            s.greater = join(s.greater, node, {node->right, hc});
+            return s;
+        }
+        if (comp(keyOf(node), key)) {
+            Split s = split({node->right, hc}, key);
+            s.less = join({node->left, hc}, node, s.less);
+            return s;
+        }
+        return {{node->left, hc}, node, {node->right, hc}};
+    }
+
+    // 把子树的所有节点放入 garbage, 由调用者在并行部分结束后统一释放(节点池不是线程安全的)
+    void collect(NodeType* node, std::vector<NodeType*>& garbage) const {
+        if (node == nil) return;
+        std::vector<NodeType*> stack{node};
+        while (!stack.empty()) {
+            NodeType* n = stack.back();
+            stack.pop_back();
+            garbage.push_back(n);
+            if (n->left != nil) stack.push_back(n->left);
+            if (n->right != nil) stack.push_back(n->right);
+        }
+    }
+
+    /*
+     * 对左右两个独立的子问题做 fork-join: 规模足够大且还有分叉预算时左半部分交给另一个线程。
+     * f(garbage) 返回子问题的结果, 各自使用自己的 garbage, 结束后合并。
+     */
+    template <typename L, typename R>
+    std::pair<Subtree, Subtree> forkJoin(std::size_t work, int forks, std::vector<NodeType*>& garbage, L&& left,
+                                         R&& right) {
+        if (forks > 0 && work >= PARALLEL_CUTOFF) {
+            std::vector<NodeType*> left_garbage;
+            auto future = std::async(std::launch::async, [&] { return left(left_garbage); });
+            Subtree r = right(garbage);
+            Subtree l = future.get();
+            garbage.insert(garbage.end(), left_garbage.begin(), left_garbage.end());
+            return {l, r};
+        }
+        Subtree l = left(garbage);
+        return {l, right(garbage)};
+    }
+
+    // 并集, key 相同时保留 a 中的元素
+    Subtree unionOf(Subtree a, Subtree b, int forks, std::vector<NodeType*>& garbage) {
+        if (a.node == nil) return b;
+        if (b.node == nil) return a;
+        std::size_t work = a.node->size + b.node->size;
+        NodeType* k = a.node;
+        int hc = childBh(k, a.bh);
+        Split s = split(b, keyOf(k));
+        if (s.match) garbage.push_back(s.match);
+
+        auto [l, r] = forkJoin(
+            work, forks, garbage,
+            [&](std::vector<NodeType*>& g) { return unionOf({k->left, hc}, s.less, forks - 1, g); },
+            [&](std::vector<NodeType*>& g) { return unionOf({k->right, hc}, s.greater, forks - 1, g); });
+        return join(l, k, r);
+    }
+
+    // 交集, 保留 a 中的元素
+    Subtree intersectionOf(Subtree a, Subtree b, int forks, std::vector<NodeType*>& garbage) {
+        if (a.node == nil || b.node == nil) {
+            collect(a.node, garbage);
+            collect(b.node, garbage);
+            return {nil, 0};
+        }
+        std::size_t work = a.node->size + b.node->size;
+        NodeType* k = a.node;
+        int hc = childBh(k, a.bh);
+        Split s = split(b, keyOf(k));
+
+        auto [l, r] = forkJoin(
+            work, forks, garbage,
+            [&](std::vector<NodeType*>& g) { return intersectionOf({k->left, hc}, s.less, forks - 1, g); },
+            [&](std::vector<NodeType*>& g) { return intersectionOf({k->right, hc}, s.greater, forks - 1, g); });
+        if (s.match) {
+            garbage.push_back(s.match);
+            return join(l, k, r);
+        }
+        garbage.push_back(k);
+        return join2(l, r);
+    }
+
+    // 差集 a - b
+    Subtree differenceOf(Subtree a, Subtree b, int forks, std::vector<NodeType*>& garbage) {
+        if (a.node == nil || b.node == nil) {
+            collect(b.node, garbage);
+            return a;
+        }
+        std::size_t work = a.node->size + b.node->size;
+        NodeType* k = b.node;
+        int hc = childBh(k, b.bh);
+        Split s = split(a, keyOf(k));
+        if (s.match) garbage.push_back(s.match);
+        garbage.push_back(k);
+
+        auto [l, r] = forkJoin(
+            work, forks, garbage,
+            [&](std::vector<NodeType*>& g) { return differenceOf(s.less, {k->left, hc}, forks - 1, g); },
+            [&](std::vector<NodeType*>& g) { return differenceOf(s.greater, {k->right, hc}, forks - 1, g); });
+        return join2(l, r);
+    }
+
+    /*
+     * 接管 other 的全部节点: 合并分配器, 把 other 的叶子从它的哨兵改指向本树的 nil; O(other.size())。
+     * 之后 other 为空树, 返回原来 other 的根(已脱离 other)。
+     */
+    Subtree adopt(RedBlackTree& other) {
+        if (other.root == other.nil) return {nil, 0};
+        Subtree t{other.root, other.blackHeight(other.root)};
+        std::vector<NodeType*> stack{other.root};
+        while (!stack.empty()) {
+            NodeType* n = stack.back();
+            stack.pop_back();
+            if (n->left == other.nil) n->left = nil;
+            else stack.push_back(n->left);
+            if (n->right == other.nil) n->right = nil;
+            else stack.push_back(n->right);
+        }
+        t.node->parent = nil;
+
+        alloc.merge(other.alloc);
+        alloc.destroy(other.nil);  // 旧哨兵所在的内存此时已属于本树的分配器
+        other.nil = other.createNil();
+        other.root = other.nil;
+        return t;
+    }
+
+    // 把批量操作的结果设为整棵树, 并释放被丢弃的节点
+    void adoptRoot(Subtree t, std::vector<NodeType*>& garbage) {
+        root = t.node;
+        if (root != nil) {
+            root->parent = nil;
+            root->color = BLACK;
+        }
+        for (NodeType* n : garbage) alloc.destroy(n);
+    }
+
+    // 分叉深度: 大约每个硬件线程一个任务
+    static int forkBudget() {
+        unsigned hw = std::thread::hardware_concurrency();
+        return hw > 1 ? static_cast<int>(std::bit_width(hw)) : 0;
+    }
+
+    // 按中序把 nodes[lo, hi) 连成平衡的子树, 深度为 red_depth 的节点(最后一层)染红, 其余为黑
+    NodeType* buildBalanced(NodeType** nodes, std::size_t lo, std::size_t hi, int depth, int red_depth) {
+        if (lo == hi) return nil;
+        std::size_t mid = lo + (hi - lo) / 2;
+        NodeType* l = buildBalanced(nodes, lo, mid, depth + 1, red_depth);
+        NodeType* r = buildBalanced(nodes, mid + 1, hi, depth + 1, red_depth);
+        return makeNode(l, nodes[mid], r, depth == red_depth ? RED : BLACK);
     }
 
     // 中序遍历(用于打印)
-    void inorder(Node<T>* node) const {
+    void inorder(NodeType* node) const {
         if (node != nil) {
             inorder(node->left);
             std::cout << node->data << "(" << (node->color == RED ? "R" : "B") << ") ";
@@ -223,115 +764,332 @@ private:
     }
 
 public:
+    /*
+     * 中序双向迭代器, end() 对应哨兵 nil, 从 end() 自减得到最大元素。
+     * 集合的元素就是 key, 只提供常量迭代器; 映射可以修改 value。
+     */
+    template <bool Const>
+    class basic_iterator {
+    private:
+        friend class RedBlackTree;
+        using TreePtr = const RedBlackTree*;
+
+        NodeType* node = nullptr;
+        TreePtr tree = nullptr;
+
+        basic_iterator(NodeType* n, TreePtr t) : node(n), tree(t) {}
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, const T&, T&>;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+
+        basic_iterator() = default;
+
+        // 非常量迭代器可以隐式转换为常量迭代器
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false>& other) : node(other.node), tree(other.tree) {}
+
+        reference operator*() const { return node->data; }
+        pointer operator->() const { return &node->data; }
+
+        basic_iterator& operator++() {
+            node = tree->successor(node);
+            return *this;
+        }
+
+        basic_iterator operator++(int) {
+            basic_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        basic_iterator& operator--() {
+            node = node == tree->nil ? tree->maximum(tree->root) : tree->predecessor(node);
+            return *this;
+        }
+
+        basic_iterator operator--(int) {
+            basic_iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        template <bool C>
+        bool operator==(const basic_iterator<C>& other) const { return node == other.node; }
+
+        template <bool C>
+        bool operator!=(const basic_iterator<C>& other) const { return node != other.node; }
+
+        template <bool>
+        friend class basic_iterator;
+    };
+
+    using const_iterator = basic_iterator<true>;
+    using iterator = std::conditional_t<std::is_same_v<KeyOf, Identity>, const_iterator, basic_iterator<false>>;
+
     // 构造函数(初始化哨兵节点和根节点)
-    RedBlackTree() {
-        nil = new Node<T>(T());
-        nil->color = BLACK;  // 哨兵节点为黑
-        nil->left = nil->right = nil->parent = nil;  // 哨兵自循环
+    explicit RedBlackTree(const Compare& c = Compare()) : comp(c) {
+        nil = createNil();
         root = nil;
     }
 
-    // 析构函数
+    RedBlackTree(const RedBlackTree&) = delete;
+    RedBlackTree& operator=(const RedBlackTree&) = delete;
+
+    // 析构函数, 节点池中的内存随 alloc 整块释放
     ~RedBlackTree() {
         destroy(root);
-        delete nil;
+        if constexpr (Alloc<NodeType>::bulk_release) nil->~NodeType();
+        else alloc.destroy(nil);
     }
 
-    // 插入操作
-    void insert(const T& val) {
-        Node<T>* z = new Node<T>(val);
-        Node<T>* y = nil;
-        Node<T>* x = root;
+    // 删除所有节点; 使用节点池时按块归还内存
+    void clear() {
+        destroy(root);
+        if constexpr (Alloc<NodeType>::bulk_release) {
+            nil->~NodeType();
+            alloc.reset();
+            nil = createNil();
+        }
+        root = nil;
+    }
+
+    // 分配器向系统申请的字节数(HeapAllocator 不统计, 返回 0)
+    std::size_t memoryUsage() const { return alloc.memoryUsage(); }
+
+    // 插入操作, 允许重复
+    void insert(const T& val) { insertNode(alloc.create(val)); }
+    void insert(T&& val) { insertNode(alloc.create(std::in_place, std::move(val))); }
 
-        // 找到插入位置
+private:
+    void insertNode(NodeType* z) {
+        NodeType* y = nil;
+        NodeType* x = root;
+
+        // 找到插入位置, 允许重复, 插入总会成功, 沿途的子树大小直接加一
         while (x != nil) {
             y = x;
-            if (z->data < x->data) {
+            ++x->size;
+            if (comp(keyOf(z), keyOf(x))) {
                 x = x->left;
             } 
             else {
                 x = x->right;
             }
         }
-        z->parent = y;
+        attach(z, y);
 
-        if (y == nil) {
-            root = z;  // 树为空，z成为根
-        } 
-        else if (z->data < y->data) {
-            y->left = z;
-        } 
-        else {
-            y->right = z;
+        if constexpr (augmented) pullPath(z);  // 重新计算插入路径上的增强信息
+        insertFixup(z);  // 修复红黑树性质
+    }
+
+public:
+    // 删除一个 key 等于 key 的元素, 返回是否删除
+    template <typename Q>
+    bool remove(const Q& key) {
+        NodeType* z = search(key);
+        if (z == nil) return false;
+        eraseNode(z);
+        return true;
+    }
+
+    // 查找操作, key 可以是任何能与 key_type 用 Compare 比较的类型
+    template <typename Q>
+    NodeType* search(const Q& key) const {
+        NodeType* current = root;
+        while (current != nil) {
+            if (comp(key, keyOf(current))) {
+                current = current->left;
+            } 
+            else if (comp(keyOf(current), key)) {
+                current = current->right;
+            }
+            else {
+                break;
+            }
         }
+        return current;  // 找到返回节点，否则返回nil
+    }
 
-        z->left = nil;
-        z->right = nil;
-        z->color = RED;  // 新节点默认红色
+    /*
+     * 映射语义的插入: key 不存在时插入, 已存在时什么也不做, 返回 (位置, 是否插入)。
+     * emplace 先用 args 构造出元素才能知道 key; tryEmplace 先用 key 查找, 存在时不构造任何对象。
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> emplaceUnique(Args&&... args) {
+        NodeType* z = alloc.create(std::in_place, std::forward<Args>(args)...);
+        auto [slot, found] = findSlot(keyOf(z));
+        if (found) {
+            alloc.destroy(z);
+            return {iterator(slot, this), false};
+        }
+        link(z, slot);
+        return {iterator(z, this), true};
+    }
 
-        insertFixup(z);  // 修复红黑树性质
+    template <typename Q, typename... Args>
+    std::pair<iterator, bool> tryEmplace(const Q& key, Args&&... args) {
+        auto [slot, found] = findSlot(key);
+        if (found) return {iterator(slot, this), false};
+        NodeType* z = alloc.create(std::in_place, std::forward<Args>(args)...);
+        link(z, slot);
+        return {iterator(z, this), true};
     }
 
-    // 删除操作
-    void remove(const T& val) {
-        Node<T>* z = search(val);
-        if (z == nil) {
-            std::cout << "值 " << val << " 不存在于树中" << std::endl;
-            return;
+    /*
+     * 用已按 key 升序排列的 [first, last) 替换树的内容, O(n):
+     * 节点按顺序分配后直接连成平衡树, 不做逐个插入的下降和修复。输入无序时结果不是合法的查找树。
+     */
+    template <typename It>
+    void buildSorted(It first, It last) {
+        clear();
+        std::vector<NodeType*> nodes;
+        if constexpr (std::forward_iterator<It>) nodes.reserve(static_cast<std::size_t>(std::distance(first, last)));
+        for (; first != last; ++first) nodes.push_back(alloc.create(std::in_place, *first));
+        for (std::size_t i = 1; i < nodes.size(); ++i) {
+            assert(!comp(keyOf(nodes[i]), keyOf(nodes[i - 1])) && "buildSorted: 输入必须有序");
         }
+        if (nodes.empty()) return;
 
-        Node<T>* y = z;
-        Node<T>* x;
-        Color yOriginalColor = y->color;
+        // 平衡划分下前 floor(log2 n) 层是满的, 最后一层染红即可让所有路径的黑节点数相同
+        int red_depth = static_cast<int>(std::bit_width(nodes.size())) - 1;
+        root = buildBalanced(nodes.data(), 0, nodes.size(), 0, red_depth);
+        root->parent = nil;
+        root->color = BLACK;
+    }
 
-        if (z->left == nil) {
-            x = z->right;
-            transplant(z, z->right);
-        } 
-        else if (z->right == nil) {
-            x = z->left;
-            transplant(z, z->left);
-        } 
-        else {
-            y = minimum(z->right);  // 找后继节点
-            yOriginalColor = y->color;
-            x = y->right;
+    /*
+     * 集合运算: 把 other 的节点并入本树后做基于 split / join 的合并, 结果留在本树, other 变为空树。
+     * 两棵树都应当是集合(key 不重复, 例如用 emplaceUnique 或 RedBlackMap 构造);
+     * key 相同的元素保留本树中的那个。
+     * 设 m 为较小一侧的大小, 合并本身的代价为 O(m log(n / m + 1)), 接管 other 的节点另需 O(other.size()),
+     * 因此把较小的树作为 other 更划算。规模较大时左右子问题用 std::async 并行。
+     */
+    void unionWith(RedBlackTree& other) {
+        if (&other == this) return;
+        Subtree b = adopt(other);
+        std::vector<NodeType*> garbage;
+        Subtree a{root, blackHeight(root)};
+        adoptRoot(unionOf(a, b, forkBudget(), garbage), garbage);
+    }
 
-            if (y->parent == z) {
-                x->parent = y;
-            } 
-            else {
-                transplant(y, y->right);
-                y->right = z->right;
-                y->right->parent = y;
-            }
-            transplant(z, y);
-            y->left = z->left;
-            y->left->parent = y;
-            y->color = z->color;
+    // 只保留同时在 other 中的元素
+    void intersectWith(RedBlackTree& other) {
+        if (&other == this) return;
+        Subtree b = adopt(other);
+        std::vector<NodeType*> garbage;
+        Subtree a{root, blackHeight(root)};
+        adoptRoot(intersectionOf(a, b, forkBudget(), garbage), garbage);
+    }
+
+    // 删除在 other 中出现的元素
+    void subtract(RedBlackTree& other) {
+        if (&other == this) {
+            clear();
+            return;
         }
+        Subtree b = adopt(other);
+        std::vector<NodeType*> garbage;
+        Subtree a{root, blackHeight(root)};
+        adoptRoot(differenceOf(a, b, forkBudget(), garbage), garbage);
+    }
 
-        delete z;  // 释放被删除节点的内存
+    // 迭代与有序查找, 接口与 std::set / std::map 相同
+    iterator begin() { return iterator(minimum(root), this); }
+    iterator end() { return iterator(nil, this); }
+    const_iterator begin() const { return const_iterator(minimum(root), this); }
+    const_iterator end() const { return const_iterator(nil, this); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
 
-        if (yOriginalColor == BLACK) {
-            deleteFixup(x);  // 只有删除黑节点才需要修复
-        }
+    template <typename Q>
+    iterator find(const Q& key) { return iterator(search(key), this); }
+    template <typename Q>
+    const_iterator find(const Q& key) const { return const_iterator(search(key), this); }
+
+    template <typename Q>
+    iterator lower_bound(const Q& key) { return iterator(lowerBoundNode(key), this); }
+    template <typename Q>
+    const_iterator lower_bound(const Q& key) const { return const_iterator(lowerBoundNode(key), this); }
+
+    template <typename Q>
+    iterator upper_bound(const Q& key) { return iterator(upperBoundNode(key), this); }
+    template <typename Q>
+    const_iterator upper_bound(const Q& key) const { return const_iterator(upperBoundNode(key), this); }
+
+    template <typename Q>
+    std::pair<iterator, iterator> equal_range(const Q& key) { return {lower_bound(key), upper_bound(key)}; }
+    template <typename Q>
+    std::pair<const_iterator, const_iterator> equal_range(const Q& key) const {
+        return {lower_bound(key), upper_bound(key)};
     }
 
-    // 查找操作
-    Node<T>* search(const T& val) const {
-        Node<T>* current = root;
-        while (current != nil && current->data != val) {
-            if (val < current->data) {
+    // 删除 pos 指向的元素, 返回其后继
+    iterator erase(const_iterator pos) {
+        NodeType* next = successor(pos.node);
+        eraseNode(pos.node);
+        return iterator(next, this);
+    }
+
+    // 节点总数
+    std::size_t size() const { return root->size; }
+    bool empty() const { return root == nil; }
+
+    // 第 k 小的元素(从0开始), k 超出范围时返回 nullptr; O(log n)
+    const T* select(std::size_t k) const {
+        if (k >= root->size) return nullptr;
+        NodeType* current = root;
+        while (true) {
+            std::size_t left = current->left->size;
+            if (k < left) {
                 current = current->left;
-            } 
+            }
+            else if (k == left) {
+                return &current->data;
+            }
             else {
+                k -= left + 1;
                 current = current->right;
             }
         }
-        return current;  // 找到返回节点，否则返回nil
     }
 
+    // key 小于 key 的元素个数; O(log n)
+    template <typename Q>
+    std::size_t rank(const Q& key) const {
+        std::size_t count = 0;
+        NodeType* current = root;
+        while (current != nil) {
+            if (comp(keyOf(current), key)) {
+                count += current->left->size + 1;
+                current = current->right;
+            }
+            else {
+                current = current->left;
+            }
+        }
+        return count;
+    }
+
+    // 落在 [lo, hi) 内的元素个数; O(log n)
+    template <typename Q1, typename Q2>
+    std::size_t countRange(const Q1& lo, const Q2& hi) const {
+        if (!comp(lo, hi)) return 0;
+        return rank(hi) - rank(lo);
+    }
+
+    /*
+     * 供自定义的增强查询使用(例如区间树的重叠查询):
+     * 从 getRoot() 出发沿 left / right 下降, 用 isNil 判断是否到达叶子, 借助 aug 剪枝
+     */
+    const NodeType* getRoot() const { return root; }
+    // 根指针本身, ConcurrentRedBlackTree 不加锁读取时需要按原子方式读它
+    NodeType* const& rootSlot() const { return root; }
+    bool isNil(const NodeType* node) const { return node == nil; }
+
     // 打印树（中序遍历，按值升序）
     void print() const {
         std::cout << "红黑树(中序遍历, R=红, B=黑): ";
@@ -1,4 +1,98 @@
-#include "RedBlackTree.h"
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "RedBlackMap.h"
+#include "PersistentRedBlackTree.h"
+#include "ConcurrentRedBlackTree.h"
+
+// 区间 [lo, hi], 按左端点排序
+struct Interval {
+    int lo, hi;
+
+    bool operator<(const Interval& other) const { return lo < other.lo || (lo == other.lo && hi < other.hi); }
+    bool operator!=(const Interval& other) const { return lo != other.lo || hi != other.hi; }
+};
+
+std::ostream& operator<<(std::ostream& os, const Interval& iv) {
+    return os << "[" << iv.lo << "," << iv.hi << "]";
+}
+
+// 区间树的增强信息: 子树中最大的右端点
+struct MaxEnd {
+    using value_type = int;
+
+    template <typename NodeT>
+    static void update(NodeT* node, const NodeT* nil) {
+        int m = node->data.hi;
+        if (node->left != nil && node->left->aug > m) m = node->left->aug;
+        if (node->right != nil && node->right->aug > m) m = node->right->aug;
+        node->aug = m;
+    }
+};
+
+// 找出任意一个与 q 相交的区间, 子树的最大右端点小于 q.lo 时整棵子树都可以跳过
+template <typename Tree>
+const Interval* findOverlap(const Tree& tree, const Interval& q) {
+    auto node = tree.getRoot();
+    while (!tree.isNil(node)) {
+        if (node->data.lo <= q.hi && q.lo <= node->data.hi) return &node->data;
+        if (!tree.isNil(node->left) && node->left->aug >= q.lo) node = node->left;
+        else node = node->right;
+    }
+    return nullptr;
+}
+
+/*
+ * 并发读写: 写线程在各自的 key 段内反复插入、删除(被删除的节点槽位随即被复用),
+ * 读线程同时不加锁地查找。常驻的 key 必须总能找到且值正确, 从未插入的 key 必须找不到,
+ * 正在变动的 key 找到时值也必须与 key 对应。返回发现的错误数。
+ */
+struct Entry {
+    int first;
+    int second;
+};
+
+int concurrentCheck() {
+    constexpr int WRITERS = 2, READERS = 4, SPAN = 512, ROUNDS = 1000;
+    ConcurrentRedBlackTree<Entry, std::less<>, SelectFirst> tree;
+    // 偶数 key 常驻, 奇数 key 由写线程反复插入删除; 负数 key 从不插入
+    for (int k = 0; k < WRITERS * SPAN; k += 2) tree.insert({k, k * 7});
+
+    std::atomic<bool> done{false};
+    std::atomic<int> errors{0};
+    std::vector<std::thread> threads;
+    for (int w = 0; w < WRITERS; ++w) {
+        threads.emplace_back([&, w] {
+            for (int round = 0; round < ROUNDS; ++round) {
+                for (int k = w * SPAN + 1; k < (w + 1) * SPAN; k += 2) tree.insert({k, k * 7});
+                for (int k = w * SPAN + 1; k < (w + 1) * SPAN; k += 2) tree.erase(k);
+            }
+        });
+    }
+    for (int r = 0; r < READERS; ++r) {
+        threads.emplace_back([&, r] {
+            unsigned x = 12345u + r;
+            while (!done.load(std::memory_order_relaxed)) {
+                x = x * 1103515245u + 12345u;
+                int k = static_cast<int>(x >> 8) % (WRITERS * SPAN);
+                auto found = tree.find(k);
+                bool bad = (k % 2 == 0 && !found) || (found && (found->first != k || found->second != k * 7)) ||
+                           tree.contains(-1 - k);
+                if (bad) errors.fetch_add(1);
+            }
+        });
+    }
+    for (int w = 0; w < WRITERS; ++w) threads[w].join();
+    done.store(true);
+    for (int r = 0; r < READERS; ++r) threads[WRITERS + r].join();
+
+    if (tree.size() != static_cast<std::size_t>(WRITERS * SPAN / 2)) errors.fetch_add(1);
+    std::cout << "并发读写: 错误 " << errors.load() << ", 重试 " << tree.retries() << " 次, 加锁读取 " << tree.fallbacks() << " 次"
+              << std::endl;
+    return errors.load();
+}
 
 // 测试示例
 int main(int argc, char const* argv[]) {
@@ -28,5 +122,52 @@ int main(int argc, char const* argv[]) {
     std::cout << "删除 10 后: ";
     rbt.print();
 
-    return 0;
+    // 顺序统计
+    std::cout << "节点数: " << rbt.size() << ", 第 2 小: " << *rbt.select(1)
+              << ", 小于 30 的个数: " << rbt.rank(30) << ", [10, 30) 内的个数: " << rbt.countRange(10, 30) << std::endl;
+
+    // 区间树
+    RedBlackTree<Interval, NodePool, MaxEnd> intervals;
+    for (Interval iv : {Interval{15, 20}, Interval{10, 30}, Interval{17, 19}, Interval{5, 20}, Interval{12, 15}, Interval{30, 40}}) {
+        intervals.insert(iv);
+    }
+    Interval q{21, 23};
+    const Interval* hit = findOverlap(intervals, q);
+    std::cout << "与 " << q << " 相交的区间: ";
+    if (hit) std::cout << *hit << std::endl;
+    else std::cout << "无" << std::endl;
+
+    // 批量构建与集合运算
+    int evens[] = {0, 2, 4, 6, 8, 10}, small[] = {3, 4, 5, 6};
+    RedBlackTree<int> a, b;
+    a.buildSorted(std::begin(evens), std::end(evens));
+    b.buildSorted(std::begin(small), std::end(small));
+    a.unionWith(b);
+    std::cout << "并集 ";
+    a.print();
+
+    // 持久化版本: 修改返回新版本, 旧版本不变
+    PersistentRedBlackTree<int> v1;
+    for (int v : {10, 20, 30}) v1 = v1.insert(v);
+    auto v2 = v1.insert(25).remove(10);
+    std::cout << "版本1:";
+    for (int v : v1) std::cout << " " << v;
+    std::cout << ", 版本2:";
+    for (int v : v2) std::cout << " " << v;
+    std::cout << std::endl;
+
+    // 映射: 透明比较器允许直接用 string_view 查找 string 类型的 key
+    RedBlackMap<std::string, int> wordCount;
+    for (std::string_view w : {"red", "black", "tree", "red", "tree", "red"}) {
+        ++wordCount[std::string(w)];
+    }
+    wordCount.try_emplace("root", 0);
+    std::cout << "词频:";
+    for (const auto& [word, count] : wordCount) std::cout << " " << word << "=" << count;
+    std::cout << std::endl;
+    std::string_view probe = "tree";
+    std::cout << "tree 出现 " << wordCount.at(probe) << " 次, 删除 black: " << wordCount.erase(std::string_view("black"))
+              << ", 剩余 " << wordCount.size() << " 个" << std::endl;
+
+    return concurrentCheck() == 0 ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+
+namespace codec {
+    /*
+     * key/value 的二进制序列化, 供快照和日志使用。
+     * 每个特化需要提供:
+     *   size(v)                    编码后的字节数
+     *   encode(out, v)             写入 out, 返回写入结束位置
+     *   decode(in, end, v)         从 [in, end) 读出, 成功时 in 前移并返回 true
+     * 自定义类型可以自行特化 Codec。
+     */
+    template<typename T>
+    struct Codec;
+
+
+    // 平凡可复制类型(整数、浮点、POD 结构体): 按内存布局原样写入, 使用本机字节序
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    struct Codec<T> {
+        static std::size_t size(const T&) { return sizeof(T); }
+
+        static char* encode(char* out, const T& v) {
+            std::memcpy(out, &v, sizeof(T));
+            return out + sizeof(T);
+        }
+
+        static bool decode(const char*& in, const char* end, T& v) {
+            if (static_cast<std::size_t>(end - in) < sizeof(T)) return false;
+            std::memcpy(&v, in, sizeof(T));
+            in += sizeof(T);
+            return true;
+        }
+    };
+
+
+    // 字符串: 4 字节长度前缀 + 原始字节
+    template<>
+    struct Codec<std::string> {
+        static std::size_t size(const std::string& v) { return sizeof(std::uint32_t) + v.size(); }
+
+        static char* encode(char* out, const std::string& v) {
+            std::uint32_t len = static_cast<std::uint32_t>(v.size());
+            std::memcpy(out, &len, sizeof(len));
+            std::memcpy(out + sizeof(len), v.data(), v.size());
+            return out + sizeof(len) + v.size();
+        }
+
+        static bool decode(const char*& in, const char* end, std::string& v) {
+            std::uint32_t len;
+            if (static_cast<std::size_t>(end - in) < sizeof(len)) return false;
+            std::memcpy(&len, in, sizeof(len));
+            if (static_cast<std::size_t>(end - in) - sizeof(len) < len) return false;
+            v.assign(in + sizeof(len), len);
+            in += sizeof(len) + len;
+            return true;
+        }
+    };
+
+
+    // 把文本解析为 T, 用于兼容旧的 "key:value" 文本存储文件
+    template<typename T>
+    bool fromString(const std::string& str, T& v) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            v = str;
+            return true;
+        }
+        else {
+            std::istringstream in(str);
+            return static_cast<bool>(in >> v);
+        }
+    }
+
+
+    // CRC-32 (IEEE 802.3), 查表法; 支持分段累加: crc = crc32(next, n, crc)
+    inline std::uint32_t crc32(const void* data, std::size_t len, std::uint32_t crc = 0) {
+        static const auto table = [] {
+            std::array<std::uint32_t, 256> t{};
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[i] = c;
+            }
+            return t;
+        }();
+
+        const auto* p = static_cast<const unsigned char*>(data);
+        crc = ~crc;
+        for (std::size_t i = 0; i < len; ++i) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+} // namespace codec
@@ -0,0 +1,198 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace epoch {
+    /*
+     * 基于纪元(epoch)的内存回收(EBR), 供无锁数据结构使用。
+     * 约定:
+     * 1. 线程访问共享节点前必须先 pin() 进入临界区, 离开时自动退出
+     * 2. 节点从结构中摘除之后调用 retire(), 而不是直接 delete
+     * 3. 全局纪元只有在所有活跃线程都已观察到当前纪元时才能推进
+     * 4. 在纪元 e 被 retire 的节点, 当全局纪元到达 e + 2 时不再被任何线程引用, 可以安全释放
+     */
+    class Domain {
+    public:
+        static constexpr int MAX_THREADS = 256;     // 同时注册的线程数上限
+        static constexpr int RETIRE_BATCH = 64;     // 每 retire 这么多个节点尝试推进一次纪元
+
+    private:
+        static constexpr std::uint64_t INACTIVE = ~std::uint64_t(0);
+
+        struct Retired {
+            void* ptr;
+            void (*deleter)(void*);
+            std::uint64_t epoch;    // retire 时观察到的全局纪元
+        };
+
+        // 每个线程一条记录, 按缓存行对齐避免伪共享
+        struct alignas(64) ThreadRecord {
+            std::atomic<std::uint64_t> local_epoch{INACTIVE};  // INACTIVE 表示不在临界区内
+            std::atomic<bool> in_use{false};
+            int nesting = 0;                    // pin 的嵌套深度, 只由持有线程访问
+            int retire_count = 0;
+            std::vector<Retired> limbo;         // 等待释放的节点, 只由持有线程访问
+        };
+
+        std::atomic<std::uint64_t> global_epoch{0};
+        ThreadRecord records[MAX_THREADS];
+
+        std::mutex orphan_mutex;
+        std::vector<Retired> orphans;           // 已退出线程遗留的待释放节点
+
+
+        // 线程退出时归还记录
+        struct ThreadHandle {
+            Domain* domain = nullptr;
+            int slot = -1;
+            ~ThreadHandle() {
+                if (domain) domain->unregisterThread(slot);
+            }
+        };
+
+
+        Domain() = default;
+
+        ~Domain() {
+            // 程序退出时已无并发访问, 释放所有剩余节点
+            for (auto& rec : records) {
+                for (auto& r : rec.limbo) r.deleter(r.ptr);
+            }
+            for (auto& r : orphans) r.deleter(r.ptr);
+        }
+
+
+        ThreadRecord& localRecord() {
+            thread_local ThreadHandle handle;
+            if (handle.slot < 0) {
+                handle.slot = registerThread();
+                handle.domain = this;
+            }
+            return records[handle.slot];
+        }
+
+
+        int registerThread() {
+            for (;;) {
+                for (int i = 0; i < MAX_THREADS; ++i) {
+                    bool expected = false;
+                    if (!records[i].in_use.load(std::memory_order_relaxed) &&
+                        records[i].in_use.compare_exchange_strong(expected, true)) {
+                        return i;
+                    }
+                }
+                // 线程数超过上限: 等待其他线程退出
+                std::this_thread::yield();
+            }
+        }
+
+
+        void unregisterThread(int slot) {
+            ThreadRecord& rec = records[slot];
+            if (!rec.limbo.empty()) {
+                std::lock_guard<std::mutex> lock(orphan_mutex);
+                orphans.insert(orphans.end(), rec.limbo.begin(), rec.limbo.end());
+                rec.limbo.clear();
+            }
+            rec.local_epoch.store(INACTIVE, std::memory_order_release);
+            rec.in_use.store(false, std::memory_order_release);
+        }
+
+
+        // 所有活跃线程都处于当前纪元时, 推进全局纪元
+        bool tryAdvance() {
+            std::uint64_t e = global_epoch.load(std::memory_order_seq_cst);
+            for (auto& rec : records) {
+                if (!rec.in_use.load(std::memory_order_acquire)) continue;
+                std::uint64_t local = rec.local_epoch.load(std::memory_order_seq_cst);
+                if (local != INACTIVE && local != e) return false;
+            }
+            return global_epoch.compare_exchange_strong(e, e + 1);
+        }
+
+
+        // 释放 limbo 中已经安全的节点
+        static void collect(std::vector<Retired>& limbo, std::uint64_t safe_epoch) {
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < limbo.size(); ++i) {
+                if (limbo[i].epoch + 2 <= safe_epoch) {
+                    limbo[i].deleter(limbo[i].ptr);
+                }
+                else {
+                    limbo[kept++] = limbo[i];
+                }
+            }
+            limbo.resize(kept);
+        }
+
+
+        void collectOrphans(std::uint64_t safe_epoch) {
+            std::unique_lock<std::mutex> lock(orphan_mutex, std::try_to_lock);
+            if (lock.owns_lock() && !orphans.empty()) collect(orphans, safe_epoch);
+        }
+
+
+    public:
+        Domain(const Domain&) = delete;
+        Domain& operator=(const Domain&) = delete;
+
+        // 进程内所有无锁结构共享同一个回收域
+        static Domain& instance() {
+            static Domain domain;
+            return domain;
+        }
+
+
+        // RAII 临界区守卫, 在其生命周期内读到的节点不会被释放
+        class Guard {
+        private:
+            ThreadRecord* rec;
+
+        public:
+            explicit Guard(ThreadRecord* r) : rec(r) {}
+            Guard(const Guard&) = delete;
+            Guard& operator=(const Guard&) = delete;
+            ~Guard() {
+                if (--rec->nesting == 0) {
+                    rec->local_epoch.store(INACTIVE, std::memory_order_release);
+                }
+            }
+        };
+
+
+        Guard pin() {
+            ThreadRecord& rec = localRecord();
+            if (rec.nesting++ == 0) {
+                rec.local_epoch.store(global_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                // 保证纪元的发布先于之后对共享指针的读取
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+            return Guard(&rec);
+        }
+
+
+        // 延迟释放节点, 必须在 pin() 的保护下调用
+        void retire(void* ptr, void (*deleter)(void*)) {
+            ThreadRecord& rec = localRecord();
+            rec.limbo.push_back({ptr, deleter, global_epoch.load(std::memory_order_seq_cst)});
+            if (++rec.retire_count >= RETIRE_BATCH) {
+                rec.retire_count = 0;
+                tryAdvance();
+                std::uint64_t e = global_epoch.load(std::memory_order_acquire);
+                collect(rec.limbo, e);
+                collectOrphans(e);
+            }
+        }
+
+
+        template<typename T>
+        void retire(T* ptr) {
+            retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+        }
+    };
+
+} // namespace epoch
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdio>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace file_util {
+    // 把文件内容刷到磁盘, 成功返回 true
+    inline bool syncFile(std::FILE* file) {
+        if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return ::fsync(fileno(file)) == 0;
+#endif
+    }
+
+
+    // 当前进程号, 用于生成不与其他进程冲突的临时文件名
+    inline unsigned long processId() {
+#ifdef _WIN32
+        return static_cast<unsigned long>(_getpid());
+#else
+        return static_cast<unsigned long>(::getpid());
+#endif
+    }
+
+
+    /*
+     * 只读映射整个文件:
+     * POSIX 下使用 mmap, 由操作系统按需换页;
+     * 其他平台退化为一次性读入内存。
+     */
+    class MappedFile {
+    private:
+        const char* base = nullptr;
+        std::size_t length = 0;
+        bool mapped = false;            // true 表示 base 来自 mmap
+        std::vector<char> fallback;     // 不支持 mmap 时的文件内容
+
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() { close(); }
+
+
+        bool open(const std::string& path) {
+            close();
+#ifndef _WIN32
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat st;
+            if (::fstat(fd, &st) != 0) {
+                ::close(fd);
+                return false;
+            }
+            length = static_cast<std::size_t>(st.st_size);
+            if (length > 0) {
+                void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    // 加载是顺序扫描, 提示内核预读
+                    ::madvise(p, length, MADV_SEQUENTIAL);
+                    base = static_cast<const char*>(p);
+                    mapped = true;
+                }
+            }
+            ::close(fd);
+            if (mapped || length == 0) return true;
+#endif
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            if (!file) return false;
+            std::fseek(file, 0, SEEK_END);
+            long size = std::ftell(file);
+            std::fseek(file, 0, SEEK_SET);
+            if (size < 0) {
+                std::fclose(file);
+                return false;
+            }
+            fallback.resize(static_cast<std::size_t>(size));
+            length = std::fread(fallback.data(), 1, fallback.size(), file);
+            std::fclose(file);
+            base = fallback.data();
+            return length == fallback.size();
+        }
+
+
+        void close() {
+#ifndef _WIN32
+            if (mapped) ::munmap(const_cast<char*>(base), length);
+#endif
+            base = nullptr;
+            length = 0;
+            mapped = false;
+            fallback.clear();
+        }
+
+
+        const char* data() const { return base; }
+        std::size_t size() const { return length; }
+    };
+
+} // namespace file_util
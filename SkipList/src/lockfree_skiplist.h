@@ -0,0 +1,324 @@
+#pragma once
+#include <iostream>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <cstdint>
+#include <optional>
+#include "./epoch.h"
+#include "./log_policy.h"
+
+
+namespace lf_node {
+    /*
+     * 无锁跳表节点。
+     * next[i] 的最低位用作逻辑删除标记:
+     * 1. 标记位为1表示该节点在第 i 层已被逻辑删除, 其 next[i] 不能再被修改
+     * 2. 第0层被标记的那一刻即为删除操作的线性化点
+     * 3. 节点地址至少按指针对齐, 最低位总是0, 可安全借用
+     */
+    template<typename K, typename V>
+    class Node {
+    public:
+        const K key;
+        const V value;      // 值在节点生命周期内不可变, 读线程无需同步
+        const int height;
+        std::unique_ptr<std::atomic<std::uintptr_t>[]> next;
+
+        // 插入线程与删除线程各持有一个"清理引用", 两者都完成后节点才能被回收
+        std::atomic<int> cleanup_refs{2};
+
+        Node(const K& k, const V& v, int h)
+            : key(k), value(v), height(h), next(new std::atomic<std::uintptr_t>[h]) {
+            for (int i = 0; i < h; ++i) next[i].store(0, std::memory_order_relaxed);
+        }
+
+        const K& getKey() const { return key; }
+        const V& getValue() const { return value; }
+    };
+
+
+    template<typename K, typename V>
+    inline Node<K, V>* getPtr(std::uintptr_t p) {
+        return reinterpret_cast<Node<K, V>*>(p & ~std::uintptr_t(1));
+    }
+
+    inline bool isMarked(std::uintptr_t p) { return p & 1; }
+
+    template<typename K, typename V>
+    inline std::uintptr_t toRaw(Node<K, V>* node) {
+        return reinterpret_cast<std::uintptr_t>(node);
+    }
+
+} // namespace lf_node
+
+
+namespace skip_list {
+    /*
+     * 无锁跳表(Fraser / Herlihy-Shavit 算法), 接口与 SkipList 保持一致。
+     * - 插入: 先在第0层 CAS 链入(线性化点), 再自底向上逐层链入
+     * - 删除: 先自顶向下标记各层 next 指针, 第0层标记成功者赢得删除, 随后由 find 物理摘除
+     * - 查找: 只读遍历, 跳过已标记节点, 不做任何写操作(wait-free)
+     * - 内存回收: 摘除后的节点交给 epoch::Domain 延迟释放
+     * LogPolicy 的钩子会被多个线程并发调用, 策略本身需要线程安全(NoLog / RingBufferTrace 均满足)
+     */
+    template<typename K, typename V, typename LogPolicy = log_policy::NoLog>
+    class LockFreeSkipList {
+    public:
+        static constexpr int MAX_LEVEL = 64;        // preds/succs 数组放在栈上, 高度上限固定
+
+    private:
+        using Node = lf_node::Node<K, V>;
+
+        int max_height;                             // 跳表的最大存储高度
+        std::atomic<int> current_height;            // 当前已使用的最高层数(只增不减, 作为查找起点的提示)
+        Node* head;                                 // 跳表虚拟头节点
+        std::atomic<int> node_count;                // 跳表中节点数量
+        [[no_unique_address]] mutable LogPolicy logger;     // 日志策略, 空策略不占空间
+
+
+    private:
+        static Node* ptr(std::uintptr_t p) { return lf_node::getPtr<K, V>(p); }
+        static std::uintptr_t raw(Node* node) { return lf_node::toRaw<K, V>(node); }
+
+
+        // 插入线程或删除线程完成清理后调用, 最后一个完成者负责回收
+        void releaseCleanupRef(Node* node) {
+            if (node->cleanup_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                epoch::Domain::instance().retire(node);
+            }
+        }
+
+
+        /*
+         * 定位 key 在每一层的前驱 preds[i] 与后继 succs[i], 途中物理摘除所有已标记节点。
+         * 返回第0层是否存在未被删除的 key。必须在 pin() 保护下调用。
+         */
+        bool find(const K& key, Node** preds, Node** succs) {
+        retry:
+            Node* pred = head;
+            for (int level = current_height.load(std::memory_order_acquire) - 1; level >= 0; --level) {
+                Node* curr = ptr(pred->next[level].load(std::memory_order_acquire));
+                while (curr) {
+                    std::uintptr_t succ = curr->next[level].load(std::memory_order_acquire);
+                    // curr 在本层已被逻辑删除, 尝试把它从 pred 之后摘除
+                    while (lf_node::isMarked(succ)) {
+                        std::uintptr_t expected = raw(curr);
+                        if (!pred->next[level].compare_exchange_strong(expected, succ & ~std::uintptr_t(1),
+                                                                       std::memory_order_acq_rel)) {
+                            // pred 已被修改或标记, 从头开始
+                            goto retry;
+                        }
+                        curr = ptr(succ);
+                        if (!curr) break;
+                        succ = curr->next[level].load(std::memory_order_acquire);
+                    }
+                    if (!curr || !(curr->getKey() < key)) break;
+                    pred = curr;
+                    curr = ptr(succ);
+                }
+                preds[level] = pred;
+                succs[level] = curr;
+            }
+            return succs[0] && succs[0]->getKey() == key;
+        }
+
+
+        // 保证当前层数提示不低于 h
+        void raiseHeight(int h) {
+            int cur = current_height.load(std::memory_order_acquire);
+            while (cur < h && !current_height.compare_exchange_weak(cur, h, std::memory_order_acq_rel)) {}
+        }
+
+
+    public:
+        LockFreeSkipList(int max_h)
+            : max_height(max_h < MAX_LEVEL ? max_h : MAX_LEVEL), current_height(1),
+              head(new Node(K(), V(), max_height)), node_count(0) {}
+
+        LockFreeSkipList(const LockFreeSkipList&) = delete;
+        LockFreeSkipList& operator=(const LockFreeSkipList&) = delete;
+
+        // 析构时不应再有并发访问, 直接沿第0层释放; 已摘除的节点由回收域负责
+        ~LockFreeSkipList() {
+            Node* node = ptr(head->next[0].load(std::memory_order_relaxed));
+            while (node) {
+                Node* next = ptr(node->next[0].load(std::memory_order_relaxed));
+                delete node;
+                node = next;
+            }
+            delete head;
+        }
+
+
+        // 返回跳表节点数量
+        int size() const {
+            return node_count.load(std::memory_order_relaxed);
+        }
+
+
+        LogPolicy& getLogger() const { return logger; }
+
+
+        // 多线程安全随机高度生成
+        int getRandomHeight() {
+            thread_local std::mt19937 rng(std::random_device{}());
+            std::bernoulli_distribution coin(0.5);
+            int h = 1;
+            while (coin(rng) && h < max_height) ++h;
+            return h;
+        }
+
+
+        // 查找节点方法, 不修改任何共享状态; 找到时返回 value 的副本
+        std::optional<V> searchNode(const K& key) const {
+            auto guard = epoch::Domain::instance().pin();
+            Node* pred = head;
+            Node* curr = nullptr;
+
+            for (int level = current_height.load(std::memory_order_acquire) - 1; level >= 0; --level) {
+                curr = ptr(pred->next[level].load(std::memory_order_acquire));
+                while (curr) {
+                    std::uintptr_t succ = curr->next[level].load(std::memory_order_acquire);
+                    // 跳过已被逻辑删除的节点
+                    if (lf_node::isMarked(succ)) {
+                        curr = ptr(succ);
+                        continue;
+                    }
+                    if (!(curr->getKey() < key)) break;
+                    pred = curr;
+                    curr = ptr(succ);
+                }
+            }
+
+            if (curr && curr->getKey() == key) {
+                logger.onSearch(key, &curr->getValue());
+                return curr->getValue();
+            }
+            logger.onSearch(key, static_cast<const V*>(nullptr));
+            return std::nullopt;
+        }
+
+
+        // 插入节点方法, 返回0表示插入成功, 返回1表示跳表中已有该节点
+        int insertNode(const K& key, const V& value) {
+            auto guard = epoch::Domain::instance().pin();
+            Node* preds[MAX_LEVEL];
+            Node* succs[MAX_LEVEL];
+
+            int top = getRandomHeight();
+            raiseHeight(top);
+            Node* new_node = nullptr;
+
+            // 第0层链入
+            for (;;) {
+                if (find(key, preds, succs)) {
+                    delete new_node;    // 从未发布过, 可直接释放
+                    logger.onInsert(key, false);
+                    return 1;           // 已存在
+                }
+                if (!new_node) new_node = new Node(key, value, top);
+                for (int i = 0; i < top; ++i) {
+                    new_node->next[i].store(raw(succs[i]), std::memory_order_relaxed);
+                }
+                std::uintptr_t expected = raw(succs[0]);
+                if (preds[0]->next[0].compare_exchange_strong(expected, raw(new_node),
+                                                              std::memory_order_acq_rel)) {
+                    break;
+                }
+            }
+            node_count.fetch_add(1, std::memory_order_relaxed);
+
+            // 自底向上链入高层; 若中途节点被并发删除则停止
+            for (int level = 1; level < top; ++level) {
+                for (;;) {
+                    Node* pred = preds[level];
+                    Node* succ = succs[level];
+                    std::uintptr_t old_next = new_node->next[level].load(std::memory_order_acquire);
+                    if (lf_node::isMarked(old_next)) goto linked;
+                    if (ptr(old_next) != succ &&
+                        !new_node->next[level].compare_exchange_strong(old_next, raw(succ),
+                                                                       std::memory_order_acq_rel)) {
+                        // 只可能是被删除线程标记
+                        goto linked;
+                    }
+                    std::uintptr_t expected = raw(succ);
+                    if (pred->next[level].compare_exchange_strong(expected, raw(new_node),
+                                                                  std::memory_order_acq_rel)) {
+                        break;
+                    }
+                    // 前驱发生变化, 重新定位; 若节点已不在第0层说明已被删除
+                    find(key, preds, succs);
+                    if (succs[0] != new_node) goto linked;
+                }
+            }
+
+        linked:
+            // 删除线程可能在我们链入高层之前完成了清理, 这里补一次摘除, 保证回收时节点不可达
+            if (lf_node::isMarked(new_node->next[0].load(std::memory_order_acquire))) {
+                find(key, preds, succs);
+            }
+            releaseCleanupRef(new_node);
+            logger.onInsert(key, true);
+            return 0;
+        }
+
+
+        // 删除节点方法, 返回是否由本线程删除成功
+        bool deleteNode(const K& key) {
+            auto guard = epoch::Domain::instance().pin();
+            Node* preds[MAX_LEVEL];
+            Node* succs[MAX_LEVEL];
+
+            if (!find(key, preds, succs)) {
+                logger.onDelete(key, false);
+                return false;
+            }
+            Node* victim = succs[0];
+
+            // 自顶向下标记高层
+            for (int level = victim->height - 1; level >= 1; --level) {
+                std::uintptr_t succ = victim->next[level].load(std::memory_order_acquire);
+                while (!lf_node::isMarked(succ)) {
+                    victim->next[level].compare_exchange_weak(succ, succ | 1, std::memory_order_acq_rel);
+                }
+            }
+
+            // 标记第0层, 成功者赢得删除
+            std::uintptr_t succ = victim->next[0].load(std::memory_order_acquire);
+            for (;;) {
+                if (lf_node::isMarked(succ)) {              // 已被其他线程删除
+                    logger.onDelete(key, false);
+                    return false;
+                }
+                if (victim->next[0].compare_exchange_weak(succ, succ | 1, std::memory_order_acq_rel)) break;
+            }
+            node_count.fetch_sub(1, std::memory_order_relaxed);
+
+            // 物理摘除各层
+            find(key, preds, succs);
+            releaseCleanupRef(victim);
+            logger.onDelete(key, true);
+            return true;
+        }
+
+
+        // 从最高层开始展示跳表, 仅在没有并发写入时调用
+        void displaySkipList() const {
+            std::cout << "\n===================== Lock-free Skip List =====================\n";
+            for (int i = current_height.load() - 1; i >= 0; --i) {
+                Node* node = ptr(head->next[i].load());
+                std::cout << "Level " << i << ": ";
+                while (node) {
+                    std::uintptr_t next = node->next[i].load();
+                    if (!lf_node::isMarked(next)) {
+                        std::cout << node->getKey() << ":" << node->getValue();
+                    }
+                    node = ptr(next);
+                    if (node) std::cout << " -> ";
+                }
+                std::cout << "\n";
+            }
+        }
+    };
+} // namespace skip_list
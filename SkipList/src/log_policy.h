@@ -0,0 +1,156 @@
+#pragma once
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+
+namespace log_policy {
+    /*
+     * 跳表的日志/追踪策略, 作为模板参数传入 SkipList。
+     * 每个策略需要提供以下钩子(均在跳表持锁期间调用, 应尽量轻量):
+     *   onSearch(key, value_ptr)   value_ptr 为 nullptr 表示未找到
+     *   onInsert(key, inserted)    inserted 为 false 表示 key 已存在
+     *   onDelete(key, deleted)
+     *   onLoadBegin() / onLoad(key, value)
+     *   onDumpBegin() / onDump(key, value)
+     */
+
+    enum class Op : std::uint8_t { Search, Insert, Delete, Load, Dump };
+
+
+    // 默认策略: 所有钩子都是空函数, 数据路径上不做任何 I/O
+    struct NoLog {
+        template<typename K, typename V> void onSearch(const K&, const V*) {}
+        template<typename K> void onInsert(const K&, bool) {}
+        template<typename K> void onDelete(const K&, bool) {}
+        void onLoadBegin() {}
+        template<typename K, typename V> void onLoad(const K&, const V&) {}
+        void onDumpBegin() {}
+        template<typename K, typename V> void onDump(const K&, const V&) {}
+    };
+
+
+    // 控制台输出, 用于演示和调试
+    struct ConsoleLog {
+        template<typename K, typename V>
+        void onSearch(const K& key, const V* value) {
+            if (value) std::cout << "Find key: " << key << ", value: " << *value << "\n";
+            else std::cout << "No key: " << key << " in skip list\n";
+        }
+
+        template<typename K>
+        void onInsert(const K& key, bool inserted) {
+            if (inserted) std::cout << "Insert key: " << key << "\n";
+            else std::cout << "key exists\n";
+        }
+
+        template<typename K>
+        void onDelete(const K& key, bool deleted) {
+            if (deleted) std::cout << "Successfully delete key: " << key << "\n";
+        }
+
+        void onLoadBegin() {
+            std::cout << "\n==================== load file ====================\n";
+        }
+
+        template<typename K, typename V>
+        void onLoad(const K& key, const V& value) {
+            std::cout << key << ":" << value << "\n";
+        }
+
+        void onDumpBegin() {
+            std::cout << "\n==================== dump file ====================\n";
+        }
+
+        template<typename K, typename V>
+        void onDump(const K& key, const V& value) {
+            std::cout << key << ":" << value << "\n";
+        }
+    };
+
+
+    /*
+     * 无锁环形缓冲区追踪器: 只记录操作类型、结果、key 的哈希和时间戳,
+     * 每条记录一次 fetch_add 加几次 relaxed 写入, 不分配内存也不做 I/O。
+     * 缓冲区写满后覆盖最旧的记录, 通过 events() 取出最近的记录用于离线分析。
+     */
+    template<std::size_t Capacity = 4096>
+    class RingBufferTrace {
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        struct Event {
+            Op op;
+            bool ok;                    // 查找命中 / 插入成功 / 删除成功
+            std::uint64_t key_hash;
+            std::uint64_t timestamp;    // steady_clock 计数
+        };
+
+    private:
+        // 每个槽位的字段都是原子变量, 并发写同一槽位(回绕)时不会产生数据竞争;
+        // seq 记录写入序号, 读取时用来判断槽位内容是否完整
+        struct Slot {
+            std::atomic<std::uint64_t> seq{0};
+            std::atomic<std::uint64_t> meta{0};
+            std::atomic<std::uint64_t> key_hash{0};
+            std::atomic<std::uint64_t> timestamp{0};
+        };
+
+        std::unique_ptr<Slot[]> slots{new Slot[Capacity]};
+        std::atomic<std::uint64_t> cursor{0};
+
+
+        template<typename K>
+        void record(Op op, const K& key, bool ok) {
+            std::uint64_t n = cursor.fetch_add(1, std::memory_order_relaxed);
+            Slot& slot = slots[n & (Capacity - 1)];
+            slot.seq.store(0, std::memory_order_relaxed);   // 标记为正在写
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.meta.store((static_cast<std::uint64_t>(op) << 1) | ok, std::memory_order_relaxed);
+            slot.key_hash.store(std::hash<K>{}(key), std::memory_order_relaxed);
+            slot.timestamp.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                                 std::memory_order_relaxed);
+            slot.seq.store(n + 1, std::memory_order_release);
+        }
+
+    public:
+        template<typename K, typename V> void onSearch(const K& key, const V* value) { record(Op::Search, key, value != nullptr); }
+        template<typename K> void onInsert(const K& key, bool inserted) { record(Op::Insert, key, inserted); }
+        template<typename K> void onDelete(const K& key, bool deleted) { record(Op::Delete, key, deleted); }
+        void onLoadBegin() {}
+        template<typename K, typename V> void onLoad(const K& key, const V&) { record(Op::Load, key, true); }
+        void onDumpBegin() {}
+        template<typename K, typename V> void onDump(const K& key, const V&) { record(Op::Dump, key, true); }
+
+
+        // 累计记录的事件总数(包括已被覆盖的)
+        std::uint64_t totalEvents() const { return cursor.load(std::memory_order_relaxed); }
+
+
+        // 按时间顺序取出缓冲区中最近的记录, 正在被写入的槽位会被跳过
+        std::vector<Event> events() const {
+            std::vector<Event> result;
+            std::uint64_t end = cursor.load(std::memory_order_acquire);
+            std::uint64_t begin = end > Capacity ? end - Capacity : 0;
+            result.reserve(end - begin);
+            for (std::uint64_t n = begin; n < end; ++n) {
+                const Slot& slot = slots[n & (Capacity - 1)];
+                if (slot.seq.load(std::memory_order_acquire) != n + 1) continue;
+                std::uint64_t meta = slot.meta.load(std::memory_order_relaxed);
+                Event e{static_cast<Op>(meta >> 1), static_cast<bool>(meta & 1),
+                        slot.key_hash.load(std::memory_order_relaxed),
+                        slot.timestamp.load(std::memory_order_relaxed)};
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.seq.load(std::memory_order_relaxed) != n + 1) continue;
+                result.push_back(e);
+            }
+            return result;
+        }
+    };
+
+} // namespace log_policy
@@ -3,8 +3,8 @@ using namespace skip_list;
 
 
 int main(int argc, char const* argv[]) {
-    // 创建跳表对象, 最大高度为10
-    SkipList<int, std::string> skipList(10);
+    // 创建跳表对象, 最大高度为10, 使用控制台日志策略打印每次操作
+    SkipList<int, std::string, log_policy::ConsoleLog> skipList(10);
 
     skipList.loadFile();
     skipList.displaySkipList();
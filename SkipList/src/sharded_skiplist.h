@@ -0,0 +1,313 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "./skiplist.h"
+
+
+namespace skip_list {
+    /*
+     * 分区策略: operator()(key, shards) 返回 key 所属的分片下标;
+     * ordered 为 true 表示分片之间按 key 有序(分片 i 的 key 都小于分片 i + 1 的 key)。
+     */
+
+    // 哈希分区: 相邻的 key 被打散到不同分片, 写入分布均匀; 分片之间无序
+    template<typename K>
+    struct HashPartitioner {
+        static constexpr bool ordered = false;
+
+        std::size_t operator()(const K& key, std::size_t shards) const {
+            // std::hash 对整数通常是恒等映射, 乘以黄金比例常数后取高位, 避免规律的 key 落到同一分片
+            std::uint64_t h = static_cast<std::uint64_t>(std::hash<K>{}(key)) * 0x9E3779B97F4A7C15ull;
+            return static_cast<std::size_t>((h >> 32) % shards);
+        }
+    };
+
+
+    // 范围分区: 分片 i 保存 [bounds[i - 1], bounds[i]) 内的 key, 超出分片数的部分归入最后一个分片
+    template<typename K>
+    struct RangePartitioner {
+        static constexpr bool ordered = true;
+
+        std::vector<K> bounds;      // 升序的分界点, 一般为 shards - 1 个
+
+        RangePartitioner() = default;
+        explicit RangePartitioner(std::vector<K> b) : bounds(std::move(b)) {}
+
+        // 把 [lo, hi) 均匀切成 shards 段, 适用于算术类型的 key
+        static RangePartitioner evenSplit(K lo, K hi, std::size_t shards) requires std::is_arithmetic_v<K> {
+            std::vector<K> b;
+            for (std::size_t i = 1; i < shards; ++i) {
+                b.push_back(static_cast<K>(lo + (hi - lo) / static_cast<K>(shards) * static_cast<K>(i)));
+            }
+            return RangePartitioner(std::move(b));
+        }
+
+        std::size_t operator()(const K& key, std::size_t shards) const {
+            std::size_t i = static_cast<std::size_t>(std::upper_bound(bounds.begin(), bounds.end(), key) - bounds.begin());
+            return i < shards ? i : shards - 1;
+        }
+    };
+
+
+    /*
+     * 分片跳表: 按 Partitioner 把 key 分到 N 个独立的 SkipList,
+     * 每个分片有自己的读写锁和节点内存池, 写不同分片的线程互不阻塞。
+     * 单个 key 的操作与 SkipList 语义相同; 跨分片的 rangeScan 与迭代不是整体的时间点视图。
+     */
+    template<typename K, typename V, typename Partitioner = HashPartitioner<K>, typename LogPolicy = log_policy::NoLog>
+    class ShardedSkipList {
+    public:
+        static constexpr std::size_t CACHE_LINE = 64;
+        using List = SkipList<K, V, LogPolicy>;
+
+    private:
+        // 每个分片按缓存行对齐单独分配, 相邻分片的锁与计数器不会伪共享
+        struct alignas(CACHE_LINE) Shard {
+            List list;
+            explicit Shard(int max_h) : list(max_h) {}
+        };
+
+        std::vector<std::unique_ptr<Shard>> shards;
+        Partitioner partitioner;
+
+
+        List& shardOf(const K& key) { return shards[partitioner(key, shards.size())]->list; }
+        const List& shardOf(const K& key) const { return shards[partitioner(key, shards.size())]->list; }
+
+
+        // 调用扫描回调, 回调返回 bool 时以其结果决定是否继续
+        template<typename F>
+        static bool invokeScan(F& callback, const K& key, const V& value) {
+            if constexpr (std::is_convertible_v<std::invoke_result_t<F&, const K&, const V&>, bool>) {
+                return static_cast<bool>(callback(key, value));
+            }
+            else {
+                callback(key, value);
+                return true;
+            }
+        }
+
+
+    public:
+        /*
+         * 跨分片的有序只读迭代器: 用最小堆归并各分片的 SkipList::const_iterator。
+         * 与 SkipList::const_iterator 一样不持有锁, 使用期间不能有并发写入。
+         */
+        class const_iterator {
+        private:
+            using Inner = typename List::const_iterator;
+            std::vector<Inner> heap;        // 各分片当前位置, 堆顶为 key 最小者; 已到末尾的分片被移出
+
+            static bool greater(const Inner& a, const Inner& b) { return b.key() < a.key(); }
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using iterator_concept = std::forward_iterator_tag;
+            using value_type = typename Inner::value_type;
+            using difference_type = std::ptrdiff_t;
+            using reference = typename Inner::reference;
+            using pointer = typename Inner::pointer;
+
+            const_iterator() = default;
+
+            explicit const_iterator(std::vector<Inner> positions) : heap(std::move(positions)) {
+                std::erase(heap, Inner());
+                std::make_heap(heap.begin(), heap.end(), greater);
+            }
+
+            const K& key() const { return heap.front().key(); }
+            const V& value() const { return heap.front().value(); }
+
+            reference operator*() const { return *heap.front(); }
+            pointer operator->() const { return heap.front().operator->(); }
+
+            const_iterator& operator++() {
+                std::pop_heap(heap.begin(), heap.end(), greater);
+                if (++heap.back() == Inner()) {
+                    heap.pop_back();
+                }
+                else {
+                    std::push_heap(heap.begin(), heap.end(), greater);
+                }
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator old = *this;
+                ++*this;
+                return old;
+            }
+
+            // 每个 key 只属于一个分片, 堆顶相同即位置相同
+            bool operator==(const const_iterator& other) const {
+                if (heap.empty() || other.heap.empty()) return heap.empty() == other.heap.empty();
+                return heap.front() == other.heap.front();
+            }
+            bool operator!=(const const_iterator& other) const { return !(*this == other); }
+        };
+
+        using iterator = const_iterator;
+
+
+        ShardedSkipList(int max_h, std::size_t shard_count, Partitioner p = Partitioner())
+            : partitioner(std::move(p)) {
+            if (shard_count == 0) shard_count = 1;
+            shards.reserve(shard_count);
+            for (std::size_t i = 0; i < shard_count; ++i) shards.push_back(std::make_unique<Shard>(max_h));
+        }
+
+        ShardedSkipList(const ShardedSkipList&) = delete;
+        ShardedSkipList& operator=(const ShardedSkipList&) = delete;
+
+
+        // 插入节点, 返回0表示插入成功, 返回1表示已有该节点
+        int insertNode(const K& key, const V& value) { return shardOf(key).insertNode(key, value); }
+
+        std::optional<V> searchNode(const K& key) const { return shardOf(key).searchNode(key); }
+
+        bool deleteNode(const K& key) { return shardOf(key).deleteNode(key); }
+
+
+        // 按分片拆分后交给各分片的批量接口, 每个分片只加一次锁; 返回实际插入的节点数
+        std::size_t insertBatch(std::span<const std::pair<K, V>> items) {
+            std::vector<std::vector<std::pair<K, V>>> parts(shards.size());
+            for (const auto& item : items) parts[partitioner(item.first, shards.size())].push_back(item);
+
+            std::size_t inserted = 0;
+            for (std::size_t i = 0; i < shards.size(); ++i) {
+                if (!parts[i].empty()) inserted += shards[i]->list.insertBatch(parts[i]);
+            }
+            return inserted;
+        }
+
+
+        // 批量删除, 返回实际删除的节点数
+        std::size_t deleteBatch(std::span<const K> keys) {
+            std::vector<std::vector<K>> parts(shards.size());
+            for (const auto& key : keys) parts[partitioner(key, shards.size())].push_back(key);
+
+            std::size_t deleted = 0;
+            for (std::size_t i = 0; i < shards.size(); ++i) {
+                if (!parts[i].empty()) deleted += shards[i]->list.deleteBatch(parts[i]);
+            }
+            return deleted;
+        }
+
+
+        /*
+         * 范围查询 [lo, hi), 按 key 升序回调, 回调返回 false 时提前结束。
+         * 范围分区: 只依次扫描与区间相交的分片, 每个分片在自己的共享锁内扫描;
+         * 哈希分区: 先在各分片锁内复制区间内的节点, 再在锁外按 key 归并。
+         * 返回访问的节点数。
+         */
+        template<typename F>
+        std::size_t rangeScan(const K& lo, const K& hi, F&& callback) const {
+            std::size_t visited = 0;
+
+            if constexpr (Partitioner::ordered) {
+                if (!(lo < hi)) return 0;
+                bool stopped = false;
+                std::size_t last = partitioner(hi, shards.size());
+                for (std::size_t i = partitioner(lo, shards.size()); i <= last && !stopped; ++i) {
+                    visited += shards[i]->list.rangeScan(lo, hi, [&](const K& key, const V& value) {
+                        stopped = !invokeScan(callback, key, value);
+                        return !stopped;
+                    });
+                }
+                return visited;
+            }
+            else {
+                std::vector<std::vector<std::pair<K, V>>> parts(shards.size());
+                for (std::size_t i = 0; i < shards.size(); ++i) {
+                    shards[i]->list.rangeScan(lo, hi, [&](const K& key, const V& value) {
+                        parts[i].emplace_back(key, value);
+                    });
+                }
+
+                // (分片下标, 分片内位置) 的最小堆
+                using Cursor = std::pair<std::size_t, std::size_t>;
+                auto greater = [&](const Cursor& a, const Cursor& b) {
+                    return parts[b.first][b.second].first < parts[a.first][a.second].first;
+                };
+                std::vector<Cursor> heap;
+                for (std::size_t i = 0; i < parts.size(); ++i) {
+                    if (!parts[i].empty()) heap.emplace_back(i, 0);
+                }
+                std::make_heap(heap.begin(), heap.end(), greater);
+
+                while (!heap.empty()) {
+                    std::pop_heap(heap.begin(), heap.end(), greater);
+                    auto& [shard, pos] = heap.back();
+                    const auto& item = parts[shard][pos];
+                    ++visited;
+                    if (!invokeScan(callback, item.first, item.second)) break;
+                    if (++pos == parts[shard].size()) {
+                        heap.pop_back();
+                    }
+                    else {
+                        std::push_heap(heap.begin(), heap.end(), greater);
+                    }
+                }
+                return visited;
+            }
+        }
+
+
+        // 有序遍历所有分片, 使用约束见 const_iterator
+        const_iterator begin() const {
+            std::vector<typename List::const_iterator> positions;
+            for (const auto& shard : shards) positions.push_back(shard->list.begin());
+            return const_iterator(std::move(positions));
+        }
+
+        const_iterator end() const { return const_iterator(); }
+
+        const_iterator lower_bound(const K& key) const {
+            std::vector<typename List::const_iterator> positions;
+            for (const auto& shard : shards) positions.push_back(shard->list.lower_bound(key));
+            return const_iterator(std::move(positions));
+        }
+
+        const_iterator upper_bound(const K& key) const {
+            std::vector<typename List::const_iterator> positions;
+            for (const auto& shard : shards) positions.push_back(shard->list.upper_bound(key));
+            return const_iterator(std::move(positions));
+        }
+
+
+        std::size_t size() const {
+            std::size_t total = 0;
+            for (const auto& shard : shards) total += static_cast<std::size_t>(shard->list.size());
+            return total;
+        }
+
+        std::size_t shardCount() const { return shards.size(); }
+
+        // 直接访问某个分片, 例如单独对其做快照
+        List& shard(std::size_t i) { return shards[i]->list; }
+        const List& shard(std::size_t i) const { return shards[i]->list; }
+
+        // 每个分片的写锁竞争次数
+        std::vector<std::uint64_t> contention() const {
+            std::vector<std::uint64_t> result;
+            for (const auto& shard : shards) result.push_back(shard->list.contention());
+            return result;
+        }
+
+        std::size_t memoryUsage() const {
+            std::size_t total = 0;
+            for (const auto& shard : shards) total += shard->list.memoryUsage();
+            return total;
+        }
+    };
+
+} // namespace skip_list
@@ -1,18 +1,38 @@
 #pragma once
 #include <iostream>
 #include <vector>
-#include <memory>
+#include <new>
+#include <cstddef>
+#include <type_traits>
 #include <mutex>
 #include <shared_mutex>
 #include <random>
 #include <fstream>
 #include <string>
+#include <optional>
+#include <span>
+#include <utility>
+#include <algorithm>
+#include <memory>
+#include <cstdint>
+#include <set>
+#include <map>
+#include <atomic>
+#include <thread>
+#include <future>
+#include <chrono>
+#include <iterator>
+#include <functional>
+#include "./log_policy.h"
+#include "./codec.h"
+#include "./snapshot.h"
+#include "./wal.h"
 
 
 namespace kv_node {
     // 跳表中的节点类
     template<typename K, typename V>
-    class Node {
+    class alignas(alignof(void*)) Node {
     public:
         K key;
         V value;
@@ -26,41 +46,280 @@ namespace kv_node {
          * 约定:
          * 1. i = 0 是最底层(完整有序链表层)
          * 2. 当前节点存在于 Level 0 ~ Level (height - 1)
-         * 3. forward.size() == height
+         * 3. forward 实际长度为 height, 必须是最后一个成员:
+         *    节点由 NodePool 按 allocSize(height) 分配, 多出的 height - 1 个指针紧跟在对象之后,
+         *    key、value 与整座指针塔位于同一块连续内存中
          * 4. 若 forward[i] == nullptr，表示该层已经到达表尾
          * 举例:
          * forward[3]表示该节点在Level 3上时指向的下一个节点
         */
-        std::vector<std::shared_ptr<Node<K, V>>> forward;   // 把它理解为next指针数组
+        Node* forward[1];   // 把它理解为next指针数组
 
 
         Node(const K& k, const V& v, int h)
-            : key(k), value(v), height(h), forward(h, nullptr) {}
+            : key(k), value(v), height(h) {
+            for (int i = 0; i < h; ++i) forward[i] = nullptr;
+        }
+
+        Node(const Node&) = delete;
+        Node& operator=(const Node&) = delete;
 
         const K& getKey() const { return key; }
         const V& getValue() const { return value; }
         void setValue(const V& val) { value = val; }
+
+        // 高度为 h 的节点实际占用的字节数
+        static constexpr std::size_t allocSize(int h) {
+            return sizeof(Node) + sizeof(Node*) * (h - 1);
+        }
     };
 
+
+    /*
+     * 每个跳表独享的节点内存池:
+     * 1. 从 64KB 的大块中顺序切分节点, 相邻插入的节点在内存中也相邻
+     * 2. 按高度分别维护空闲链表, 删除的节点只归还到池中, 供同高度的新节点复用
+     * 3. 不是线程安全的, 由跳表的写锁保护
+     * 4. 池析构时整块释放内存, 但不会调用节点析构函数, 由跳表负责
+     */
     template<typename K, typename V>
-    using NodeVec = std::vector<std::shared_ptr<Node<K, V>>>;
+    class NodePool {
+    private:
+        using NodeType = Node<K, V>;
+        static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+        static constexpr std::size_t ALIGN = alignof(NodeType) > alignof(std::max_align_t)
+                                                 ? alignof(NodeType) : alignof(std::max_align_t);
+
+        std::vector<char*> blocks;          // 已申请的所有内存块
+        char* cursor = nullptr;             // 当前块中下一个可用位置
+        std::size_t remaining = 0;          // 当前块剩余字节数
+        std::vector<void*> free_lists;      // free_lists[h] 为高度 h 的空闲节点链表, 链接指针存放在节点首部
+        std::size_t bytes_reserved = 0;     // 向系统申请的总字节数
+
+
+        static std::size_t roundUp(std::size_t n) {
+            return (n + alignof(NodeType) - 1) & ~(alignof(NodeType) - 1);
+        }
+
+
+        char* allocateBlock(std::size_t bytes) {
+            char* block = static_cast<char*>(::operator new(bytes, std::align_val_t(ALIGN)));
+            blocks.push_back(block);
+            bytes_reserved += bytes;
+            return block;
+        }
+
+
+        void* allocate(int h) {
+            if (void* p = free_lists[h]) {
+                free_lists[h] = *static_cast<void**>(p);
+                return p;
+            }
+
+            std::size_t bytes = roundUp(NodeType::allocSize(h));
+            // 超大节点单独占一块, 不打乱当前块的切分
+            if (bytes > BLOCK_SIZE / 4) return allocateBlock(bytes);
+
+            if (bytes > remaining) {
+                cursor = allocateBlock(BLOCK_SIZE);
+                remaining = BLOCK_SIZE;
+            }
+            void* p = cursor;
+            cursor += bytes;
+            remaining -= bytes;
+            return p;
+        }
+
+
+    public:
+        explicit NodePool(int max_h) : free_lists(max_h + 1, nullptr) {}
+
+        NodePool(const NodePool&) = delete;
+        NodePool& operator=(const NodePool&) = delete;
+
+        ~NodePool() {
+            for (char* block : blocks) ::operator delete(block, std::align_val_t(ALIGN));
+        }
+
+
+        // 在池中构造一个高度为 h 的节点
+        NodeType* create(const K& key, const V& value, int h) {
+            void* p = allocate(h);
+            return new (p) NodeType(key, value, h);
+        }
+
+
+        // 析构节点并把内存归还给同高度的空闲链表
+        void destroy(NodeType* node) {
+            int h = node->height;
+            node->~NodeType();
+            void* p = node;
+            *static_cast<void**>(p) = free_lists[h];
+            free_lists[h] = p;
+        }
+
+
+        // 池向系统申请的总字节数
+        std::size_t memoryUsage() const { return bytes_reserved; }
+    };
 
 } // namespace kv_node
 
 
 namespace skip_list {
     const std::string delimiter = ":";
-    const std::string STORE_FILE = "../store/dumpFile.txt";
+    const std::string STORE_FILE = "../store/dumpFile.snap";     // 默认快照路径
 
-    // 实现跳表类
-    template<typename K, typename V>
+    // 后台快照的统计信息, 时间单位为秒
+    struct SnapshotStats {
+        bool ok = false;            // 快照是否成功写入
+        std::uint64_t records = 0;  // 写入的记录数
+        std::uint64_t wal_lsn = 0;  // 快照对应的 WAL 位置
+        std::size_t chunks = 0;     // 分几次持锁复制
+        double duration = 0;        // 从开始到文件替换完成的总耗时
+        double lock_held = 0;       // 累计持有共享锁的时间
+        double max_stall = 0;       // 单次持锁的最长时间, 即写线程最多因快照被阻塞多久
+    };
+
+    /*
+     * 实现跳表类
+     * LogPolicy: 日志/追踪策略(见 log_policy.h), 默认 NoLog 不做任何 I/O;
+     * 演示时可以使用 log_policy::ConsoleLog 打印每次操作
+     */
+    template<typename K, typename V, typename LogPolicy = log_policy::NoLog>
     class SkipList {
+    public:
+        static constexpr int MAX_LEVEL = 64;        // update 数组放在栈上, 高度上限固定
+        static constexpr std::size_t SNAPSHOT_CHUNK = 1024;     // 后台快照每次持锁复制的节点数
+
     private:
+        using Node = kv_node::Node<K, V>;
+
+        /*
+         * 后台快照的时间点视图, 由 rw_mutex 保护:
+         * 快照线程按 key 升序分段复制, cursor 之前的部分已经复制完毕;
+         * 写线程修改 cursor 之后的 key 时在这里登记, 使快照看到的仍是开始时刻的内容。
+         * 跳表不会原地修改 value, 所以只需要记录插入和删除。
+         */
+        struct SnapshotState {
+            bool active = false;
+            std::optional<K> cursor;            // 已复制的最大 key, 为空表示尚未开始
+            std::set<K> inserted_beyond;        // 快照开始后插入的 key, 不属于快照
+            std::map<K, V> erased_beyond;       // 快照开始后被删除的节点, 仍属于快照
+        };
+
         int max_height;                             // 跳表的最大存储高度
         int current_height;                         // 跳表当前已存储的高度, 最小为1
-        std::shared_ptr<kv_node::Node<K,V>> head;   // 跳表虚拟头节点
+        kv_node::NodePool<K, V> pool;               // 节点内存池, 每个跳表独享
+        Node* head;                                 // 跳表虚拟头节点
         int node_count;                             // 跳表中节点数量
         mutable std::shared_mutex rw_mutex;         // 读写锁
+        [[no_unique_address]] mutable LogPolicy logger;     // 日志策略, 空策略不占空间
+        std::shared_ptr<wal::WriteAheadLog<K, V>> wal_log;  // 预写日志, 为空表示未启用; 写操作在锁内复制一份, 锁外等待落盘
+        SnapshotState snap;                         // 进行中的后台快照
+        std::mutex snapshot_mutex;                  // 串行化所有快照写入(同步、后台、检查点), 并保护 snapshot_thread
+        std::thread snapshot_thread;                // 后台快照线程
+        std::atomic<bool> snapshot_running{false};
+        mutable std::atomic<std::uint64_t> contended_locks{0};  // 写线程获取独占锁时需要等待的次数
+
+
+    public:
+        /*
+         * 沿第 0 层顺序遍历的只读迭代器, 按 key 升序访问 (key, value)。
+         * 迭代器不持有锁: 使用期间不能有并发的写操作(或由调用者在外部加锁),
+         * 被删除的节点会回到内存池中复用, 指向它的迭代器随之失效。
+         * 并发场景请使用 rangeScan。
+         */
+        class const_iterator {
+        private:
+            const Node* node = nullptr;
+
+            struct ArrowProxy {
+                std::pair<const K&, const V&> ref;
+                const std::pair<const K&, const V&>* operator->() const { return &ref; }
+            };
+
+        public:
+            // 节点中 key 和 value 分开存放, 解引用返回引用二者的 pair, 不满足旧式前向迭代器的要求
+            using iterator_category = std::input_iterator_tag;
+            using iterator_concept = std::forward_iterator_tag;
+            using value_type = std::pair<const K&, const V&>;
+            using difference_type = std::ptrdiff_t;
+            using reference = value_type;
+            using pointer = ArrowProxy;
+
+            const_iterator() = default;
+            explicit const_iterator(const Node* n) : node(n) {}
+
+            const K& key() const { return node->getKey(); }
+            const V& value() const { return node->getValue(); }
+
+            reference operator*() const { return {node->getKey(), node->getValue()}; }
+            pointer operator->() const { return {**this}; }
+
+            const_iterator& operator++() {
+                node = node->forward[0];
+                // 提前把下一个节点取进缓存, 与调用者处理当前元素重叠
+                if (node) prefetch(node->forward[0]);
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator old = *this;
+                ++*this;
+                return old;
+            }
+
+            bool operator==(const const_iterator& other) const { return node == other.node; }
+            bool operator!=(const const_iterator& other) const { return node != other.node; }
+        };
+
+        using iterator = const_iterator;
+
+
+    private:
+        // 获取独占锁, 锁已被占用时计入 contended_locks
+        std::unique_lock<std::shared_mutex> lockExclusive() const {
+            std::unique_lock<std::shared_mutex> lock(rw_mutex, std::try_to_lock);
+            if (!lock.owns_lock()) {
+                contended_locks.fetch_add(1, std::memory_order_relaxed);
+                lock.lock();
+            }
+            return lock;
+        }
+
+
+        static void prefetch(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(p, 0, 1);
+#else
+            (void)p;
+#endif
+        }
+
+
+        // 第一个 key 不小于 key 的节点, 只从塔顶下降一次; 调用者需持有锁(或保证没有并发写)
+        const Node* lowerBoundNode(const K& key) const {
+            const Node* node = head;
+            for (int i = current_height - 1; i >= 0; --i) {
+                while (node->forward[i] && node->forward[i]->getKey() < key) {
+                    node = node->forward[i];
+                }
+            }
+            return node->forward[0];
+        }
+
+
+        // 第一个 key 大于 key 的节点
+        const Node* upperBoundNode(const K& key) const {
+            const Node* node = head;
+            for (int i = current_height - 1; i >= 0; --i) {
+                while (node->forward[i] && !(key < node->forward[i]->getKey())) {
+                    node = node->forward[i];
+                }
+            }
+            return node->forward[0];
+        }
 
 
     private:
@@ -77,10 +336,354 @@ namespace skip_list {
         }
 
 
+        // 把手指重置到 head, 之后可以定位任意 key
+        void resetFinger(Node** update) const {
+            for (int i = 0; i < max_height; ++i) update[i] = head;
+        }
+
+
+        /*
+         * 定位 key 在各层的前驱, 结果写回 update。
+         * update 同时作为"手指": 其中保存的是上一次定位的前驱(或上一次插入的节点),
+         * 本次 key 必须不小于上一次的 key, 每一层都从上层下来的位置和 update[i] 中
+         * 更靠后且仍小于 key 的那个继续向后查找。
+         * 调用者需持有锁。
+         */
+        void fingerSeek(Node** update, const K& key) const {
+            // 上一个 key 已是表尾且小于本次 key: 各层前驱就是各层表尾, 无需移动
+            Node* last = update[0];
+            if (last->forward[0] == nullptr && (last == head || last->getKey() < key)) return;
+
+            Node* node = head;
+            for (int i = current_height - 1; i >= 0; --i) {
+                Node* finger = update[i];
+                if (finger != head && finger->getKey() < key &&
+                    (node == head || node->getKey() < finger->getKey())) {
+                    node = finger;
+                }
+                // 把forward[i]理解成next指针, node->forward[i]->getKey() < key, 不断逼近key
+                while (node->forward[i] && node->forward[i]->getKey() < key) {
+                    node = node->forward[i];
+                }
+                update[i] = node;
+            }
+        }
+
+
+        // 在 fingerSeek 定位好的位置插入节点, key 已存在时返回 false; 插入后 update 指向新节点
+        bool insertAt(Node** update, const K& key, const V& value) {
+            // 第0层的节点
+            Node* node = update[0]->forward[0];
+            if (node && node->getKey() == key) {
+                logger.onInsert(key, false);
+                return false;
+            }
+
+            int random_h = getRandomHeight();
+            if (random_h > current_height) {
+                for (int i = current_height; i < random_h; ++i) {
+                    update[i] = head;
+                }
+                current_height = random_h;
+            }
+
+            Node* new_node = pool.create(key, value, random_h);
+            // 从下到上更新update数组中的节点
+            for (int i = 0; i < random_h; ++i) {
+                new_node->forward[i] = update[i]->forward[i];
+                update[i]->forward[i] = new_node;
+                update[i] = new_node;
+            }
+            ++node_count;
+
+            if (snap.active && beyondCursor(key)) snap.inserted_beyond.insert(key);
+            logger.onInsert(key, true);
+            return true;
+        }
+
+
+        // 删除 fingerSeek 定位好的位置上的节点, 不存在时返回 false; update 中的前驱保持有效
+        bool eraseAt(Node** update, const K& key) {
+            // 第0层的节点
+            Node* node = update[0]->forward[0];
+            // 跳表中不存在节点key
+            if (!node || !(node->getKey() == key)) {
+                logger.onDelete(key, false);
+                return false;
+            }
+
+            // 从下到上更新update数组中的节点
+            for (int i = 0; i < current_height; ++i) {
+                // 第 i 层没有待删除结点, 更高层也不会有, 直接退出
+                if (update[i]->forward[i] != node) break;
+                update[i]->forward[i] = node->forward[i];
+            }
+            // 快照还没复制到的节点先留一份副本; 快照开始后才插入的节点本来就不属于快照
+            if (snap.active && beyondCursor(key) && snap.inserted_beyond.erase(key) == 0) {
+                snap.erased_beyond.emplace(key, node->getValue());
+            }
+            logger.onDelete(key, true);
+            pool.destroy(node);
+
+            // 删除节点后可能会减小跳表高度, 需要在这里更新跳表, 删掉没有节点的层
+            while (current_height > 1 && head->forward[current_height - 1] == nullptr) {
+                --current_height;
+            }
+
+            --node_count;
+            return true;
+        }
+
+
+        /*
+         * buildFromSorted 的实现, 调用者需持有独占锁;
+         * visit 在处理每个元素前被调用, on_insert 在元素实际插入后被调用
+         */
+        template<typename InputIt, typename Visit, typename OnInsert>
+        std::size_t appendSorted(InputIt first, InputIt last, Visit&& visit, OnInsert&& on_insert) {
+            Node* update[MAX_LEVEL];
+            resetFinger(update);
+
+            std::size_t inserted = 0;
+            const K* prev = nullptr;
+            for (; first != last; ++first) {
+                const auto& item = *first;
+                visit(item);
+                if (prev && item.first < *prev) resetFinger(update);
+                fingerSeek(update, item.first);
+                bool ok = insertAt(update, item.first, item.second);
+                if (ok) {
+                    ++inserted;
+                    on_insert(item.first, item.second);
+                }
+                // 插入成功时 update[0] 就是新节点, 否则 key 已存在于 update[0] 之后
+                const Node* at = ok ? update[0] : update[0]->forward[0];
+                prev = &at->getKey();
+            }
+            return inserted;
+        }
+
+
+        // 从二进制快照加载: 内存映射 + 线性构建
+        bool loadSnapshot(const std::string& path, std::uint64_t& wal_lsn) {
+            snapshot::Reader<K, V> reader;
+            if (!reader.open(path)) {
+                std::cerr << "Failed to load snapshot " << path << ": " << reader.lastError() << std::endl;
+                return false;
+            }
+
+            std::unique_lock<std::shared_mutex> lock(rw_mutex);
+            logger.onLoadBegin();
+            appendSorted(reader.begin(), reader.end(),
+                         [this](const auto& item) { logger.onLoad(item.first, item.second); },
+                         [](const K&, const V&) {});
+            wal_lsn = reader.walLsn();
+            return true;
+        }
+
+
+        // 兼容旧的 "key:value" 文本存储文件
+        bool loadTextFile(const std::string& path) {
+            std::ifstream file_reader(path);
+            if (!file_reader.is_open()) return false;
+
+            std::vector<std::pair<K, V>> items;
+            std::string line;
+            // 读取一行
+            while (getline(file_reader, line)) {
+                std::string key, value;
+                getKeyValueFromString(line, key, value);
+                if (key.empty() || value.empty()) continue;
+                items.emplace_back();
+                if (!codec::fromString(key, items.back().first) ||
+                    !codec::fromString(value, items.back().second)) {
+                    items.pop_back();
+                }
+            }
+            file_reader.close();
+            std::stable_sort(items.begin(), items.end(),
+                             [](const auto& a, const auto& b) { return a.first < b.first; });
+
+            std::unique_lock<std::shared_mutex> lock(rw_mutex);
+            logger.onLoadBegin();
+            appendSorted(items.begin(), items.end(),
+                         [this](const auto& item) { logger.onLoad(item.first, item.second); },
+                         [](const K&, const V&) {});
+            return true;
+        }
+
+
+        // 写操作在独占锁内记下的日志位置, 锁外由 syncWal 等待它落盘
+        struct WalTicket {
+            std::shared_ptr<wal::WriteAheadLog<K, V>> log;
+            std::uint64_t lsn = 0;
+        };
+
+        // 以下三个函数在未启用 WAL 时什么也不做; log* 需在持有独占锁时调用, 保证日志顺序与修改顺序一致
+        void logInsert(WalTicket& ticket, const K& key, const V& value) {
+            if (!wal_log) return;
+            if (!ticket.log) ticket.log = wal_log;
+            ticket.lsn = wal_log->logInsert(key, value);
+        }
+
+        void logDelete(WalTicket& ticket, const K& key) {
+            if (!wal_log) return;
+            if (!ticket.log) ticket.log = wal_log;
+            ticket.lsn = wal_log->logDelete(key);
+        }
+
+        // 落盘失败时抛出 wal::SyncError, 日志从此进入失败状态, 之后的写操作同样会抛出
+        static void syncWal(const WalTicket& ticket) {
+            if (ticket.lsn != 0 && !ticket.log->sync(ticket.lsn)) {
+                throw wal::SyncError("Failed to sync write-ahead log");
+            }
+        }
+
+
+        // 在当前内容之上重放 lsn 大于 after_lsn 的日志记录, 返回重放的记录数
+        std::size_t replayWal(std::uint64_t after_lsn) {
+            std::unique_lock<std::shared_mutex> lock(rw_mutex);
+            wal_log->advanceTo(after_lsn);
+            return wal_log->replay(after_lsn, [this](wal::OpType op, const K& key, const V& value) {
+                Node* update[MAX_LEVEL];
+                resetFinger(update);
+                fingerSeek(update, key);
+                if (op == wal::OpType::Insert) insertAt(update, key, value);
+                else eraseAt(update, key);
+            });
+        }
+
+
+        // key 是否在后台快照尚未复制到的部分, 调用者需持有锁
+        bool beyondCursor(const K& key) const {
+            return !snap.cursor || *snap.cursor < key;
+        }
+
+
+        /*
+         * 从游标之后复制至多 SNAPSHOT_CHUNK 个节点到 chunk, 并按 key 顺序合并已被删除的快照节点。
+         * 调用者需持有共享锁: 写线程被排除在外, 只有快照线程会修改 snap。
+         * 返回是否已复制完整个跳表, 复制完时结束快照。
+         */
+        bool copySnapshotChunk(std::vector<std::pair<K, V>>& chunk) {
+            const Node* node = head->forward[0];
+            if (snap.cursor) {
+                Node* update[MAX_LEVEL];
+                resetFinger(update);
+                fingerSeek(update, *snap.cursor);
+                node = update[0]->forward[0];
+                if (node && !(*snap.cursor < node->getKey())) node = node->forward[0];
+            }
+
+            auto erased = snap.erased_beyond.begin();
+            for (std::size_t i = 0; node && i < SNAPSHOT_CHUNK; ++i, node = node->forward[0]) {
+                const K& key = node->getKey();
+                while (erased != snap.erased_beyond.end() && !(key < erased->first)) {
+                    chunk.push_back(*erased++);
+                }
+                if (!snap.inserted_beyond.contains(key)) chunk.emplace_back(key, node->getValue());
+                snap.cursor = key;
+            }
+
+            if (node == nullptr) {
+                for (; erased != snap.erased_beyond.end(); ++erased) chunk.push_back(*erased);
+                snap = SnapshotState{};
+                return true;
+            }
+            // 游标之前的登记已经用不到了
+            snap.erased_beyond.erase(snap.erased_beyond.begin(), erased);
+            snap.inserted_beyond.erase(snap.inserted_beyond.begin(), snap.inserted_beyond.upper_bound(*snap.cursor));
+            return false;
+        }
+
+
+        // 后台快照线程: 分段持有共享锁复制节点, 在锁外编码并写盘
+        SnapshotStats runSnapshot(snapshot::Writer<K, V>& writer, bool opened, std::uint64_t wal_lsn) {
+            using Clock = std::chrono::steady_clock;
+            auto start = Clock::now();
+            SnapshotStats stats;
+            stats.wal_lsn = wal_lsn;
+
+            std::vector<std::pair<K, V>> chunk;
+            chunk.reserve(SNAPSHOT_CHUNK);
+            bool done = false;
+            bool ok = opened;
+            while (!done) {
+                chunk.clear();
+                {
+                    std::shared_lock<std::shared_mutex> lock(rw_mutex);
+                    auto locked = Clock::now();
+                    done = copySnapshotChunk(chunk);
+                    double held = std::chrono::duration<double>(Clock::now() - locked).count();
+                    stats.lock_held += held;
+                    if (held > stats.max_stall) stats.max_stall = held;
+                }
+                ++stats.chunks;
+
+                // 写盘失败也要继续复制到底, 以结束写线程的登记
+                for (const auto& [key, value] : chunk) {
+                    ok = ok && writer.append(key, value);
+                    logger.onDump(key, value);
+                }
+            }
+
+            stats.records = writer.recordCount();
+            stats.ok = ok && writer.commit();
+            if (writer.superseded()) std::cerr << "Snapshot not written, the target file is newer" << std::endl;
+            stats.duration = std::chrono::duration<double>(Clock::now() - start).count();
+            return stats;
+        }
+
+
+        // 等待进行中的后台快照写完, 调用者需持有 snapshot_mutex
+        void joinSnapshot() {
+            if (snapshot_thread.joinable()) snapshot_thread.join();
+        }
+
+        // 把跳表写成快照并记录其对应的 WAL 位置, 调用者需持有 snapshot_mutex 和 rw_mutex
+        bool writeSnapshot(const std::string& path) {
+            snapshot::Writer<K, V> writer;
+            if (!writer.open(path, wal_log ? wal_log->lastLsn() : 0)) {
+                std::cerr << "Failed to open file for writing: " << path << std::endl;
+                return false;
+            }
+
+            logger.onDumpBegin();
+
+            //只遍历跳表的第0层级
+            const Node* node = this->head->forward[0];
+            while (node) {
+                writer.append(node->getKey(), node->getValue());
+                logger.onDump(node->getKey(), node->getValue());
+                node = node->forward[0];
+            }
+            if (writer.commit()) return true;
+            if (writer.superseded()) std::cerr << "Snapshot not written, " << path << " is newer" << std::endl;
+            return false;
+        }
+
+
     public:
         SkipList(int max_h)
-            : max_height(max_h), current_height(1), node_count(0),
-              head(std::make_shared<kv_node::Node<K,V>>(K(), V(), max_h)) {}
+            : max_height(max_h < MAX_LEVEL ? max_h : MAX_LEVEL), current_height(1),
+              pool(max_height), head(pool.create(K(), V(), max_height)), node_count(0) {}
+
+        SkipList(const SkipList&) = delete;
+        SkipList& operator=(const SkipList&) = delete;
+
+        // 节点内存随内存池整块释放, 这里只需要调用节点的析构函数; 先等待后台快照结束
+        ~SkipList() {
+            if (snapshot_thread.joinable()) snapshot_thread.join();
+
+            if constexpr (!std::is_trivially_destructible_v<Node>) {
+                Node* node = head;
+                while (node) {
+                    Node* next = node->forward[0];
+                    node->~Node();
+                    node = next;
+                }
+            }
+        }
 
 
         // 返回跳表节点数量
@@ -90,6 +693,23 @@ namespace skip_list {
         }
 
 
+        // 写操作因锁被占用而等待的次数, 用于观察锁竞争
+        std::uint64_t contention() const {
+            return contended_locks.load(std::memory_order_relaxed);
+        }
+
+
+        // 返回节点内存池占用的字节数
+        std::size_t memoryUsage() const {
+            std::shared_lock<std::shared_mutex> lock(rw_mutex);
+            return pool.memoryUsage();
+        }
+
+
+        // 取得日志策略对象, 例如读取 RingBufferTrace 中的记录
+        LogPolicy& getLogger() const { return logger; }
+
+
         // 多线程安全随机高度生成
         int getRandomHeight() {
             thread_local std::mt19937 rng(std::random_device{}());
@@ -100,10 +720,10 @@ namespace skip_list {
         }
 
 
-        // 查找节点方法, 多线程安全, 可并发查找
-        bool searchNode(const K& key) const {
+        // 查找节点方法, 多线程安全, 可并发查找; 找到时返回 value 的副本
+        std::optional<V> searchNode(const K& key) const {
             std::shared_lock<std::shared_mutex> lock(rw_mutex); // 共享锁允许多线程读
-            auto current = head;
+            const Node* current = head;
 
             // 从最高层级开始查找
             for (int level = current_height - 1; level >= 0; --level) {
@@ -114,103 +734,197 @@ namespace skip_list {
                 }
             }
 
-            bool result = false;
-
             // 第 0 层有所有节点
             current = current->forward[0];
             if (current && current->getKey() == key) {
-                std::cout << "Find key: " << key << ", value: " << current->getValue() << "\n";
-                result = true;
-            }
-            else {
-                std::cout << "No key: " << key << " in skip list\n";
+                logger.onSearch(key, &current->getValue());
+                return current->getValue();
             }
 
-            return result;
+            logger.onSearch(key, static_cast<const V*>(nullptr));
+            return std::nullopt;
         }
 
 
         // 插入节点方法, 返回0表示插入成功, 返回1表示跳表中已有该节点
         int insertNode(const K& key, const V& value) {
-            std::unique_lock<std::shared_mutex> lock(rw_mutex);     // 独占锁保证写安全
+            WalTicket ticket;
+            {
+                auto lock = lockExclusive();    // 独占锁保证写安全
 
-            // 插入节点后, 需要更新forward数组的节点存放在在数组update里, 下标对应跳表中的索引
-            kv_node::NodeVec<K,V> update(max_height);
-            auto node = head;       // 遍历节点
+                // 插入节点后, 需要更新forward数组的节点存放在在数组update里, 下标对应跳表中的索引
+                Node* update[MAX_LEVEL];
+                resetFinger(update);
+                fingerSeek(update, key);
 
-            // 从当前最高层级开始存储所有需要更新forward数组的节点
-            for (int i = current_height - 1; i >= 0; --i) {
-                while (node->forward[i] && node->forward[i]->getKey() < key) {
-                    node = node->forward[i];
-                }
-                update[i] = node;
+                if (!insertAt(update, key, value)) return 1;    // 已存在
+                logInsert(ticket, key, value);
             }
+            // 在锁外等待日志落盘, 并发的写线程可以共享同一次 fsync
+            syncWal(ticket);
+            return 0;
+        }
 
-            // 第0层的节点
-            node = node->forward[0];
-            if (node && node->getKey() == key) {
-                std::cout << "key exists\n";
-                return 1; // 已存在
+
+        // 删除节点方法, 返回是否删除了节点
+        bool deleteNode(const K& key) {
+            WalTicket ticket;
+            {
+                auto lock = lockExclusive();    // 独占锁保证写安全
+
+                // 删除节点后, 需要更新forward数组的节点存放在在数组update里, 下标对应跳表中的索引
+                Node* update[MAX_LEVEL];
+                resetFinger(update);
+                fingerSeek(update, key);
+
+                if (!eraseAt(update, key)) return false;
+                logDelete(ticket, key);
             }
+            syncWal(ticket);
+            return true;
+        }
 
-            int random_h = getRandomHeight();
-            if (random_h > current_height) {
-                for (int i = current_height; i < random_h; ++i) {
-                    update[i] = head;
+
+        /*
+         * 批量插入: 先按 key 排序, 再在一次独占锁内按升序插入,
+         * 每个 key 从上一个 key 的前驱(手指)继续向后查找, 不必每次从 head 重新下降。
+         * 批内重复的 key 只有第一次出现的生效, 与 insertNode 一致不会覆盖已有的值。
+         * 返回实际插入的节点数。
+         */
+        std::size_t insertBatch(std::span<const std::pair<K, V>> items) {
+            std::vector<const std::pair<K, V>*> sorted;
+            sorted.reserve(items.size());
+            for (const auto& item : items) sorted.push_back(&item);
+            std::stable_sort(sorted.begin(), sorted.end(),
+                             [](const auto* a, const auto* b) { return a->first < b->first; });
+
+            std::size_t inserted = 0;
+            WalTicket ticket;
+            {
+                auto lock = lockExclusive();
+                Node* update[MAX_LEVEL];
+                resetFinger(update);
+
+                for (const auto* item : sorted) {
+                    fingerSeek(update, item->first);
+                    if (insertAt(update, item->first, item->second)) {
+                        ++inserted;
+                        logInsert(ticket, item->first, item->second);
+                    }
                 }
-                current_height = random_h;
             }
+            // 整批只等待一次落盘
+            syncWal(ticket);
+            return inserted;
+        }
 
-            auto new_node = std::make_shared<kv_node::Node<K,V>>(key, value, random_h);
-            // 从下到上更新update数组中的节点
-            for (int i = 0; i < random_h; ++i) {
-                new_node->forward[i] = update[i]->forward[i];
-                update[i]->forward[i] = new_node;
+
+        /*
+         * 范围查询: 按 key 升序对 [lo, hi) 内的每个节点调用 callback(key, value)。
+         * 只从塔顶下降一次定位 lo, 之后沿第 0 层顺序读取并预取下一个节点。
+         * callback 返回 bool 时, 返回 false 提前结束。整个扫描持有共享锁, callback 中不能修改跳表。
+         * 返回访问的节点数。
+         */
+        template<typename F>
+        std::size_t rangeScan(const K& lo, const K& hi, F&& callback) const {
+            std::shared_lock<std::shared_mutex> lock(rw_mutex);
+            std::size_t visited = 0;
+            for (const Node* node = lowerBoundNode(lo); node && node->getKey() < hi; node = node->forward[0]) {
+                if (const Node* next = node->forward[0]) prefetch(next);
+                ++visited;
+                if constexpr (std::is_convertible_v<std::invoke_result_t<F&, const K&, const V&>, bool>) {
+                    if (!callback(node->getKey(), node->getValue())) break;
+                }
+                else {
+                    callback(node->getKey(), node->getValue());
+                }
             }
-            ++node_count;
-            
-            std::cout << "Insert key: " << key << "\n";
-            // 插入节点成功
-            return 0;
+            return visited;
         }
 
 
-        // 删除节点方法
-        void deleteNode(const K& key) {
-            std::unique_lock<std::shared_mutex> lock(rw_mutex);      // 独占锁保证写安全
+        // 有序遍历, 使用约束见 const_iterator
+        const_iterator begin() const { return const_iterator(head->forward[0]); }
+        const_iterator end() const { return const_iterator(); }
 
-            // 删除节点后, 需要更新forward数组的节点存放在在数组update里, 下标对应跳表中的索引
-            kv_node::NodeVec<K, V> update(max_height);
-            auto node = head;
+        // 第一个 key 不小于 key 的位置
+        const_iterator lower_bound(const K& key) const { return const_iterator(lowerBoundNode(key)); }
 
-            // 从当前最高层级开始存储所有需要更新forward数组的节点
-            for (int i = current_height - 1; i >= 0; --i) {
-                while (node->forward[i] && node->forward[i]->getKey() < key) {
-                    node = node->forward[i];
+        // 第一个 key 大于 key 的位置
+        const_iterator upper_bound(const K& key) const { return const_iterator(upperBoundNode(key)); }
+
+
+        // 批量查找, 结果与 keys 一一对应; 整批只加一次共享锁
+        std::vector<std::optional<V>> searchBatch(std::span<const K> keys) const {
+            std::vector<std::size_t> order(keys.size());
+            for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+            std::sort(order.begin(), order.end(),
+                      [&](std::size_t a, std::size_t b) { return keys[a] < keys[b]; });
+
+            std::vector<std::optional<V>> result(keys.size());
+            std::shared_lock<std::shared_mutex> lock(rw_mutex);
+            Node* update[MAX_LEVEL];
+            resetFinger(update);
+
+            for (std::size_t idx : order) {
+                const K& key = keys[idx];
+                fingerSeek(update, key);
+                const Node* node = update[0]->forward[0];
+                if (node && node->getKey() == key) {
+                    logger.onSearch(key, &node->getValue());
+                    result[idx] = node->getValue();
+                }
+                else {
+                    logger.onSearch(key, static_cast<const V*>(nullptr));
                 }
-                update[i] = node;
             }
+            return result;
+        }
 
-            // 第0层的节点
-            node = node->forward[0];
-            // 跳表中存在节点key
-            if (node && node->getKey() == key) {
-                // 从下到上更新update数组中的节点
-                for (int i = current_height - 1; i >= 0; --i) {
-                    // 第 i 层没有待删除结点, 直接退出
-                    if (update[i]->forward[i] != node) break;
-                    update[i]->forward[i] = node->forward[i];
-                }
-                
-                // 删除节点后可能会减小跳表高度, 需要在这里更新跳表, 删掉没有节点的层
-                while (current_height > 1 && head->forward[current_height - 1] == nullptr) {
-                    --current_height;
+
+        // 批量删除, 整批只加一次独占锁, 返回实际删除的节点数
+        std::size_t deleteBatch(std::span<const K> keys) {
+            std::vector<const K*> sorted;
+            sorted.reserve(keys.size());
+            for (const auto& key : keys) sorted.push_back(&key);
+            std::sort(sorted.begin(), sorted.end(), [](const K* a, const K* b) { return *a < *b; });
+
+            std::size_t deleted = 0;
+            WalTicket ticket;
+            {
+                auto lock = lockExclusive();
+                Node* update[MAX_LEVEL];
+                resetFinger(update);
+
+                for (const K* key : sorted) {
+                    fingerSeek(update, *key);
+                    if (eraseAt(update, *key)) {
+                        ++deleted;
+                        logDelete(ticket, *key);
+                    }
                 }
+            }
+            syncWal(ticket);
+            return deleted;
+        }
 
-                --node_count;
 
-                std::cout << "Successfully delete key: " << key << std::endl;
+        /*
+         * 从按 key 升序排列的 (key, value) 序列构建跳表, 元素类型需提供 first / second。
+         * 新 key 大于表中所有 key 时直接挂到各层表尾, 每个元素期望 O(1);
+         * 输入出现逆序时退化为从 head 重新定位, 结果仍然正确。返回实际插入的节点数。
+         */
+        template<typename InputIt>
+        std::size_t buildFromSorted(InputIt first, InputIt last) {
+            std::size_t inserted = 0;
+            WalTicket ticket;
+            {
+                auto lock = lockExclusive();
+                inserted = appendSorted(first, last, [](const auto&) {},
+                                        [&](const K& key, const V& value) { logInsert(ticket, key, value); });
             }
+            syncWal(ticket);
+            return inserted;
         }
 
 
@@ -220,7 +934,7 @@ namespace skip_list {
 
             std::cout << "\n========================= Skip List =========================\n";
             for (int i = current_height - 1; i >= 0; --i) {
-                auto node = head->forward[i];
+                const Node* node = head->forward[i];
                 std::cout << "Level " << i << ": ";
                 while (node) {
                     std::cout << node->getKey() << ":" << node->getValue();
@@ -232,46 +946,113 @@ namespace skip_list {
         }
 
 
-        void loadFile() {
-            std::ifstream file_reader(STORE_FILE);
-            if (!file_reader.is_open()) return;
+        /*
+         * 启用预写日志: 之后每次成功的插入/删除都会先写日志, 落盘后才返回。
+         * 落盘失败时写操作抛出 wal::SyncError, 此时修改已在内存中生效但没有持久化。
+         * 恢复时应先调用 openWal, 再调用 loadFile, 由 loadFile 在快照之上重放日志。
+         */
+        bool openWal(const std::string& path) {
+            auto log = std::make_unique<wal::WriteAheadLog<K, V>>();
+            if (!log->open(path)) {
+                std::cerr << "Failed to open write-ahead log: " << path << std::endl;
+                return false;
+            }
+            std::unique_lock<std::shared_mutex> lock(rw_mutex);
+            wal_log = std::move(log);
+            return true;
+        }
 
-            std::cout << "\n==================== load file ====================" << std::endl;
-            
-            std::string line;
-            // 读取一行
-            while (getline(file_reader, line)) {
-                std::string key, value;
-                getKeyValueFromString(line, key, value);
-                if (key.empty() || value.empty()) continue;
-                std::cout << key << delimiter << value << std::endl; 
-                insertNode(stoi(key), value);
+
+        // 预写日志对象, 未启用时为 nullptr; 可用于读取组提交统计
+        wal::WriteAheadLog<K, V>* getWal() { return wal_log.get(); }
+
+
+        /*
+         * 从文件加载跳表, 自动识别二进制快照和旧的 "key:value" 文本格式;
+         * 启用了预写日志时, 在快照之上重放快照之后的日志记录
+         */
+        bool loadFile(const std::string& path = STORE_FILE) {
+            std::uint64_t snapshot_lsn = 0;
+            bool loaded = false;
+
+            std::ifstream probe(path, std::ios::binary);
+            if (probe.is_open()) {
+                char magic[sizeof(snapshot::Header)] = {};
+                probe.read(magic, sizeof(magic));
+                bool binary = snapshot::isSnapshot(magic, static_cast<std::size_t>(probe.gcount()));
+                probe.close();
+
+                loaded = binary ? loadSnapshot(path, snapshot_lsn) : loadTextFile(path);
+                // 快照存在但已损坏时不能只靠日志恢复
+                if (!loaded) return false;
             }
 
-            file_reader.close();
+            if (wal_log && replayWal(snapshot_lsn) > 0) loaded = true;
+            return loaded;
         }
 
 
-        // 加独占锁的写文件方法
-        void dumpFile() {
-            std::unique_lock<std::shared_mutex> lock(rw_mutex);
-            std::ofstream file_writer(STORE_FILE, std::ios::out | std::ios::binary);
-            if (!file_writer.is_open()) {
-                std::cerr << "Failed to open file for writing: " << STORE_FILE << std::endl;
-                return;
-            }
-            
-            std::cout << "\n==================== dump fil e====================" << std::endl;
-            
-            //只遍历跳表的第0层级
-            auto node = this->head->forward[0];
-            while (node) {
-                file_writer << node->getKey() << delimiter << node->getValue() << std::endl;
-                std::cout << node->getKey() << delimiter << node->getValue() << std::endl;
-                node = node->forward[0];
+        // 把跳表写成二进制快照, 只读遍历, 持有共享锁即可; 先等待进行中的后台快照
+        bool dumpFile(const std::string& path = STORE_FILE) {
+            std::lock_guard<std::mutex> guard(snapshot_mutex);
+            joinSnapshot();
+            std::shared_lock<std::shared_mutex> lock(rw_mutex);
+            return writeSnapshot(path);
+        }
+
+
+        /*
+         * 后台快照: 写入的是调用时刻的时间点视图, 期间插入、查找、删除照常进行。
+         * 快照线程每次只持有共享锁复制 SNAPSHOT_CHUNK 个节点, 编码和写盘都在锁外完成;
+         * 写线程修改尚未复制的 key 时做少量登记, 保证快照的一致性。
+         * 同一时刻只允许一个后台快照, 已有快照在进行时返回的结果 ok 为 false;
+         * dumpFile 和 checkpoint 会先等它写完, 写快照的操作不会同时进行。
+         * 快照记录开始时刻的 WAL 位置, 但不会清空日志; 目标处已有更新的快照时不覆盖, ok 为 false。
+         */
+        std::future<SnapshotStats> dumpFileAsync(const std::string& path = STORE_FILE) {
+            std::promise<SnapshotStats> promise;
+            std::future<SnapshotStats> result = promise.get_future();
+
+            std::lock_guard<std::mutex> guard(snapshot_mutex);
+            if (snapshot_running.load()) {
+                promise.set_value(SnapshotStats{});
+                return result;
             }
-            file_writer.flush();
-            file_writer.close();
+            joinSnapshot();
+
+            std::uint64_t wal_lsn = 0;
+            {
+                std::unique_lock<std::shared_mutex> lock(rw_mutex);
+                snap = SnapshotState{};
+                snap.active = true;
+                wal_lsn = wal_log ? wal_log->lastLsn() : 0;
+                logger.onDumpBegin();
+            }
+
+            snapshot_running.store(true);
+            snapshot_thread = std::thread([this, path, wal_lsn, promise = std::move(promise)]() mutable {
+                snapshot::Writer<K, V> writer;
+                bool opened = writer.open(path, wal_lsn);
+                if (!opened) std::cerr << "Failed to open file for writing: " << path << std::endl;
+                SnapshotStats stats = runSnapshot(writer, opened, wal_lsn);
+                snapshot_running.store(false);
+                promise.set_value(stats);
+            });
+            return result;
+        }
+
+
+        /*
+         * 检查点: 写快照后清空预写日志。
+         * 先等待进行中的后台快照写完, 它较旧的快照不会在清空日志之后盖掉检查点。
+         * 全程持有共享锁, 写线程无法追加日志, 快照与日志的分界点是确定的。
+         */
+        bool checkpoint(const std::string& path = STORE_FILE) {
+            std::lock_guard<std::mutex> guard(snapshot_mutex);
+            joinSnapshot();
+            std::shared_lock<std::shared_mutex> lock(rw_mutex);
+            if (!writeSnapshot(path)) return false;
+            return !wal_log || wal_log->reset();
         }
     };
 } // namespace skip_list
@@ -0,0 +1,352 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+#include "./codec.h"
+#include "./file_util.h"
+
+
+namespace snapshot {
+    /*
+     * 跳表二进制快照格式(所有整数为本机字节序):
+     *
+     *   Header  | magic[8] = "SKLSNAP\0" | u32 version | u32 header_size | u64 wal_lsn (v2) |
+     *   Records | u32 payload_len | key (codec) | value (codec) |  ... 按 key 升序
+     *   Footer  | u64 record_count | u32 crc32(Records) | u32 FOOTER_MAGIC |
+     *
+     * header_size 记录头部总长度, 新版本可以在头部末尾追加字段而不影响旧的读取逻辑。
+     * v2 增加 wal_lsn: 快照已包含的最后一条 WAL 记录的序号, 恢复时只重放其后的记录; v1 文件视为 0。
+     * 写入先落到临时文件, fsync 之后再原子地替换目标文件, 崩溃时不会留下半个快照。
+     * 临时文件名带进程号和序号, 同时写同一个目标的多个 Writer 互不覆盖;
+     * 目标处已有 wal_lsn 更大的快照时放弃替换, 较旧的快照不会盖掉较新的。
+     */
+    inline constexpr char MAGIC[8] = {'S', 'K', 'L', 'S', 'N', 'A', 'P', '\0'};
+    inline constexpr std::uint32_t VERSION = 2;
+    inline constexpr std::uint32_t V1_HEADER_SIZE = 16;
+    inline constexpr std::uint32_t FOOTER_MAGIC = 0x534B4C45;   // "SKLE"
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t header_size;
+        std::uint64_t wal_lsn;      // v2
+    };
+
+    struct Footer {
+        std::uint64_t record_count;
+        std::uint32_t crc;
+        std::uint32_t magic;
+    };
+
+
+    // 判断一段数据是否以快照头开始, 用于区分旧的文本存储文件
+    inline bool isSnapshot(const char* data, std::size_t size) {
+        return size >= V1_HEADER_SIZE && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+    }
+
+
+    // 读取 path 处快照头中的 wal_lsn(v1 为 0); 文件不存在或不是快照时返回 false
+    inline bool storedWalLsn(const std::string& path, std::uint64_t& wal_lsn) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) return false;
+        Header header{};
+        std::size_t n = std::fread(&header, 1, sizeof(header), file);
+        std::fclose(file);
+        if (!isSnapshot(reinterpret_cast<const char*>(&header), n)) return false;
+        bool has_lsn = header.version >= 2 && header.header_size >= sizeof(Header) && n >= sizeof(Header);
+        wal_lsn = has_lsn ? header.wal_lsn : 0;
+        return true;
+    }
+
+
+    namespace detail {
+        inline std::atomic<std::uint64_t> tmp_sequence{0};
+    }
+
+
+    // 顺序写入快照, 记录必须按 key 升序追加
+    template<typename K, typename V>
+    class Writer {
+    public:
+        static constexpr std::size_t BUFFER_SIZE = 1 << 20;    // 1MB 写缓冲, 每次整块交给系统调用
+
+    private:
+        std::FILE* file = nullptr;
+        std::string path;
+        std::string tmp_path;
+        std::vector<char> buffer;
+        std::size_t used = 0;
+        std::uint32_t crc = 0;
+        std::uint64_t count = 0;
+        std::uint64_t lsn = 0;
+        bool failed = false;
+        bool superseded_ = false;
+
+
+        bool writeRaw(const char* data, std::size_t len) {
+            if (failed) return false;
+            if (std::fwrite(data, 1, len, file) != len) failed = true;
+            return !failed;
+        }
+
+
+        bool flushBuffer() {
+            if (used == 0) return !failed;
+            crc = codec::crc32(buffer.data(), used, crc);
+            bool ok = writeRaw(buffer.data(), used);
+            used = 0;
+            return ok;
+        }
+
+
+        void abandon() {
+            if (file) {
+                std::fclose(file);
+                file = nullptr;
+                std::error_code ec;
+                std::filesystem::remove(tmp_path, ec);
+            }
+        }
+
+
+    public:
+        Writer() : buffer(BUFFER_SIZE) {}
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        ~Writer() { abandon(); }
+
+
+        bool open(const std::string& target, std::uint64_t wal_lsn = 0) {
+            abandon();
+            path = target;
+            tmp_path = target + ".tmp." + std::to_string(file_util::processId()) + "." +
+                       std::to_string(detail::tmp_sequence.fetch_add(1));
+            file = std::fopen(tmp_path.c_str(), "wb");
+            if (!file) return false;
+            // 关闭 stdio 自身的缓冲, 由 1MB 的 buffer 直接写入
+            std::setvbuf(file, nullptr, _IONBF, 0);
+
+            used = 0;
+            crc = 0;
+            count = 0;
+            lsn = wal_lsn;
+            failed = false;
+            superseded_ = false;
+
+            Header header{};
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            header.header_size = sizeof(Header);
+            header.wal_lsn = wal_lsn;
+            return writeRaw(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+
+        bool append(const K& key, const V& value) {
+            std::uint32_t payload = static_cast<std::uint32_t>(codec::Codec<K>::size(key) +
+                                                               codec::Codec<V>::size(value));
+            std::size_t need = sizeof(payload) + payload;
+            if (need > BUFFER_SIZE - used && !flushBuffer()) return false;
+
+            // 超过缓冲区大小的记录单独编码
+            std::vector<char> large;
+            char* out = buffer.data() + used;
+            if (need > BUFFER_SIZE) {
+                large.resize(need);
+                out = large.data();
+            }
+
+            char* p = out;
+            std::memcpy(p, &payload, sizeof(payload));
+            p = codec::Codec<K>::encode(p + sizeof(payload), key);
+            codec::Codec<V>::encode(p, value);
+            ++count;
+
+            if (!large.empty()) {
+                crc = codec::crc32(large.data(), need, crc);
+                return writeRaw(large.data(), need);
+            }
+            used += need;
+            return true;
+        }
+
+
+        /*
+         * 写入文件尾并刷盘, 然后用临时文件替换目标文件。
+         * 目标处已有 wal_lsn 更大的快照时放弃, superseded() 为 true。
+         * 检查与替换之间没有加锁, 同一目标的写入者需要由调用者串行化。
+         */
+        bool commit() {
+            if (!file) return false;
+            flushBuffer();
+            Footer footer{count, crc, FOOTER_MAGIC};
+            writeRaw(reinterpret_cast<const char*>(&footer), sizeof(footer));
+            if (!failed && !file_util::syncFile(file)) failed = true;
+            if (failed) {
+                abandon();
+                return false;
+            }
+            std::uint64_t existing = 0;
+            if (storedWalLsn(path, existing) && existing > lsn) {
+                superseded_ = true;
+                abandon();
+                return false;
+            }
+            std::fclose(file);
+            file = nullptr;
+
+            std::error_code ec;
+            std::filesystem::rename(tmp_path, path, ec);
+            if (!ec) return true;
+            std::filesystem::remove(tmp_path, ec);
+            return false;
+        }
+
+
+        std::uint64_t recordCount() const { return count; }
+
+        // 上一次 commit 因为目标处已有更新的快照而放弃
+        bool superseded() const { return superseded_; }
+    };
+
+
+    // 通过内存映射读取快照, 以输入迭代器的方式逐条解码, 不额外复制整个文件
+    template<typename K, typename V>
+    class Reader {
+    private:
+        file_util::MappedFile file;
+        const char* records_begin = nullptr;
+        const char* records_end = nullptr;
+        std::uint64_t count = 0;
+        std::uint32_t version = 0;
+        std::uint64_t wal_lsn = 0;
+        std::string error;
+
+
+        bool fail(const char* msg) {
+            error = msg;
+            file.close();
+            return false;
+        }
+
+
+    public:
+        class iterator {
+        private:
+            const char* pos = nullptr;
+            const char* end = nullptr;
+            std::pair<K, V> current;
+
+            // 解码 pos 处的记录; 数据损坏时直接跳到末尾
+            void decode() {
+                if (pos == end) return;
+                std::uint32_t payload;
+                const char* p = pos + sizeof(payload);
+                if (static_cast<std::size_t>(end - pos) < sizeof(payload)) {
+                    pos = end;
+                    return;
+                }
+                std::memcpy(&payload, pos, sizeof(payload));
+                const char* record_end = p + payload;
+                if (payload > static_cast<std::size_t>(end - p) ||
+                    !codec::Codec<K>::decode(p, record_end, current.first) ||
+                    !codec::Codec<V>::decode(p, record_end, current.second)) {
+                    pos = end;
+                }
+            }
+
+            const char* next() const {
+                std::uint32_t payload;
+                std::memcpy(&payload, pos, sizeof(payload));
+                return pos + sizeof(payload) + payload;
+            }
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = std::pair<K, V>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const value_type*;
+            using reference = const value_type&;
+
+            iterator() = default;
+            iterator(const char* p, const char* e) : pos(p), end(e) { decode(); }
+
+            reference operator*() const { return current; }
+            pointer operator->() const { return &current; }
+
+            iterator& operator++() {
+                pos = next();
+                decode();
+                return *this;
+            }
+
+            bool operator==(const iterator& other) const { return pos == other.pos; }
+            bool operator!=(const iterator& other) const { return pos != other.pos; }
+        };
+
+
+        // 打开并校验快照: 头部、尾部、整个记录区的 CRC 以及记录条数
+        bool open(const std::string& path) {
+            error.clear();
+            if (!file.open(path)) return fail("cannot open snapshot file");
+
+            const char* data = file.data();
+            std::size_t size = file.size();
+            if (!isSnapshot(data, size)) return fail("not a snapshot file");
+
+            // 先读出各版本共有的部分, 再按 header_size 读取新版本追加的字段
+            Header header{};
+            std::memcpy(&header, data, V1_HEADER_SIZE);
+            if (header.version == 0 || header.version > VERSION) return fail("unsupported snapshot version");
+            if (header.header_size < V1_HEADER_SIZE || size < header.header_size + sizeof(Footer)) {
+                return fail("truncated snapshot file");
+            }
+            std::memcpy(&header, data, header.header_size < sizeof(Header) ? header.header_size : sizeof(Header));
+
+            Footer footer;
+            std::memcpy(&footer, data + size - sizeof(Footer), sizeof(footer));
+            if (footer.magic != FOOTER_MAGIC) return fail("missing snapshot footer");
+
+            records_begin = data + header.header_size;
+            records_end = data + size - sizeof(Footer);
+            if (codec::crc32(records_begin, records_end - records_begin) != footer.crc) {
+                return fail("snapshot checksum mismatch");
+            }
+
+            // 逐条走一遍记录的长度字段: 记录必须恰好铺满记录区, 条数与文件尾一致
+            std::uint64_t records = 0;
+            for (const char* p = records_begin; p != records_end; ++records) {
+                std::uint32_t payload;
+                if (static_cast<std::size_t>(records_end - p) < sizeof(payload)) return fail("truncated snapshot record");
+                std::memcpy(&payload, p, sizeof(payload));
+                p += sizeof(payload);
+                if (payload > static_cast<std::size_t>(records_end - p)) return fail("truncated snapshot record");
+                p += payload;
+            }
+            if (records != footer.record_count) return fail("snapshot record count mismatch");
+
+            count = footer.record_count;
+            version = header.version;
+            wal_lsn = header.version >= 2 ? header.wal_lsn : 0;
+            return true;
+        }
+
+
+        iterator begin() const { return iterator(records_begin, records_end); }
+        iterator end() const { return iterator(records_end, records_end); }
+
+        std::uint64_t size() const { return count; }
+        std::uint32_t formatVersion() const { return version; }
+        std::uint64_t walLsn() const { return wal_lsn; }
+        const std::string& lastError() const { return error; }
+    };
+
+} // namespace snapshot
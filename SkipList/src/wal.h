@@ -0,0 +1,257 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "./codec.h"
+#include "./file_util.h"
+
+
+namespace wal {
+    /*
+     * 跳表的预写日志(WAL), 只追加写入。每条记录:
+     *
+     *   | u32 crc32(payload) | u32 payload_len | payload |
+     *   payload = | u64 lsn | u8 op | key (codec) | value (codec, 仅插入) |
+     *
+     * lsn 从 1 开始严格递增, 截断日志后也不会回退, 可以与快照头中的 wal_lsn 直接比较。
+     * 恢复时遇到长度不足或校验失败的记录即认为是崩溃时写了一半的尾部, 从该处截断。
+     */
+    enum class OpType : std::uint8_t { Insert = 1, Delete = 2 };
+
+
+    // 日志写盘或 fsync 失败: 记录已经在内存中生效, 但不能保证持久化
+    class SyncError : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+
+    template<typename K, typename V>
+    class WriteAheadLog {
+    private:
+        static constexpr std::size_t RECORD_HEADER = sizeof(std::uint32_t) * 2;
+
+        std::mutex wal_mutex;
+        std::condition_variable flushed;
+        std::FILE* file = nullptr;
+        std::string path;
+
+        std::vector<char> pending;          // 已分配 lsn 但尚未写入文件的记录
+        std::uint64_t last_lsn = 0;         // 最后分配的 lsn
+        std::uint64_t durable_lsn = 0;      // 已经 fsync 到磁盘的最大 lsn
+        bool flushing = false;              // 是否有线程(leader)正在写盘
+        bool failed = false;                // 写盘失败后不再接受新的持久化请求
+
+        std::uint64_t sync_count = 0;       // fsync 次数
+        std::uint64_t record_count = 0;     // 写入的记录数
+
+
+        std::uint64_t appendRecord(OpType op, const K& key, const V* value) {
+            std::uint32_t payload = static_cast<std::uint32_t>(
+                sizeof(std::uint64_t) + 1 + codec::Codec<K>::size(key) + (value ? codec::Codec<V>::size(*value) : 0));
+
+            std::lock_guard<std::mutex> lock(wal_mutex);
+            std::uint64_t lsn = ++last_lsn;
+            std::size_t offset = pending.size();
+            pending.resize(offset + RECORD_HEADER + payload);
+
+            char* body = pending.data() + offset + RECORD_HEADER;
+            char* p = body;
+            std::memcpy(p, &lsn, sizeof(lsn));
+            p += sizeof(lsn);
+            *p++ = static_cast<char>(op);
+            p = codec::Codec<K>::encode(p, key);
+            if (value) codec::Codec<V>::encode(p, *value);
+
+            std::uint32_t crc = codec::crc32(body, payload);
+            std::memcpy(pending.data() + offset, &crc, sizeof(crc));
+            std::memcpy(pending.data() + offset + sizeof(crc), &payload, sizeof(payload));
+            ++record_count;
+            return lsn;
+        }
+
+
+        /*
+         * 扫描日志文件, 对每条完整记录调用 visit(lsn, op, key, value)。
+         * 返回有效数据的长度, 之后的字节是写了一半的尾部。
+         */
+        template<typename Visit>
+        static std::size_t scan(const std::string& file_path, Visit&& visit) {
+            file_util::MappedFile mapped;
+            if (!mapped.open(file_path)) return 0;
+
+            const char* begin = mapped.data();
+            const char* end = begin + mapped.size();
+            const char* pos = begin;
+            while (static_cast<std::size_t>(end - pos) >= RECORD_HEADER) {
+                std::uint32_t crc, payload;
+                std::memcpy(&crc, pos, sizeof(crc));
+                std::memcpy(&payload, pos + sizeof(crc), sizeof(payload));
+                const char* body = pos + RECORD_HEADER;
+                if (payload > static_cast<std::size_t>(end - body) || codec::crc32(body, payload) != crc) break;
+
+                const char* p = body;
+                const char* record_end = body + payload;
+                std::uint64_t lsn;
+                K key{};
+                V value{};
+                if (payload < sizeof(lsn) + 1) break;
+                std::memcpy(&lsn, p, sizeof(lsn));
+                p += sizeof(lsn);
+                OpType op = static_cast<OpType>(*p++);
+                if (!codec::Codec<K>::decode(p, record_end, key)) break;
+                if (op == OpType::Insert && !codec::Codec<V>::decode(p, record_end, value)) break;
+
+                visit(lsn, op, key, value);
+                pos = record_end;
+            }
+            return static_cast<std::size_t>(pos - begin);
+        }
+
+
+    public:
+        WriteAheadLog() = default;
+        WriteAheadLog(const WriteAheadLog&) = delete;
+        WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+        ~WriteAheadLog() {
+            if (file) {
+                // 尽力把剩余记录写盘
+                if (!pending.empty()) std::fwrite(pending.data(), 1, pending.size(), file);
+                file_util::syncFile(file);
+                std::fclose(file);
+            }
+        }
+
+
+        // 打开(或创建)日志文件用于追加, 截掉崩溃留下的半条记录, lsn 从文件中最后一条记录之后继续
+        bool open(const std::string& file_path) {
+            std::lock_guard<std::mutex> lock(wal_mutex);
+            path = file_path;
+
+            std::uint64_t max_lsn = 0;
+            std::size_t valid = scan(path, [&](std::uint64_t lsn, OpType, const K&, const V&) { max_lsn = lsn; });
+            std::error_code ec;
+            if (std::filesystem::exists(path, ec) && std::filesystem::file_size(path, ec) != valid) {
+                std::filesystem::resize_file(path, valid, ec);
+                if (ec) return false;
+            }
+
+            file = std::fopen(path.c_str(), "ab");
+            if (!file) return false;
+            if (max_lsn > last_lsn) last_lsn = max_lsn;
+            durable_lsn = last_lsn;
+            return true;
+        }
+
+
+        /*
+         * 重放 lsn 大于 after_lsn 的记录: apply(op, key, value)。
+         * 必须在 open 之后、追加新记录之前调用。返回重放的记录数。
+         */
+        template<typename Apply>
+        std::size_t replay(std::uint64_t after_lsn, Apply&& apply) {
+            std::size_t applied = 0;
+            scan(path, [&](std::uint64_t lsn, OpType op, const K& key, const V& value) {
+                if (lsn <= after_lsn) return;
+                apply(op, key, value);
+                ++applied;
+            });
+            return applied;
+        }
+
+
+        // 追加一条记录到内存缓冲区, 返回其 lsn; 调用 sync(lsn) 后才保证落盘
+        std::uint64_t logInsert(const K& key, const V& value) { return appendRecord(OpType::Insert, key, &value); }
+        std::uint64_t logDelete(const K& key) { return appendRecord(OpType::Delete, key, nullptr); }
+
+
+        /*
+         * 组提交: 等待 lsn 之前的所有记录落盘。
+         * 第一个到达的线程成为 leader, 把所有线程已缓冲的记录一次性写入并 fsync;
+         * 其余线程在条件变量上等待, 醒来后发现自己的记录已经落盘即可返回。
+         */
+        bool sync(std::uint64_t lsn) {
+            std::unique_lock<std::mutex> lock(wal_mutex);
+            while (durable_lsn < lsn) {
+                if (failed) return false;
+                if (flushing) {
+                    flushed.wait(lock);
+                    continue;
+                }
+
+                flushing = true;
+                std::vector<char> batch;
+                batch.swap(pending);
+                std::uint64_t batch_lsn = last_lsn;
+                lock.unlock();
+
+                bool ok = batch.empty() ||
+                          (std::fwrite(batch.data(), 1, batch.size(), file) == batch.size() &&
+                           file_util::syncFile(file));
+
+                lock.lock();
+                flushing = false;
+                if (ok) {
+                    if (batch_lsn > durable_lsn) durable_lsn = batch_lsn;
+                    ++sync_count;
+                }
+                else {
+                    failed = true;
+                }
+                flushed.notify_all();
+            }
+            return true;
+        }
+
+
+        /*
+         * 检查点之后清空日志文件: 调用者需保证 last lsn 之前的修改都已写入快照,
+         * 并且在此期间没有新的记录追加(持有跳表的锁)。
+         */
+        bool reset() {
+            std::unique_lock<std::mutex> lock(wal_mutex);
+            flushed.wait(lock, [this] { return !flushing; });
+            pending.clear();
+            durable_lsn = last_lsn;
+            flushed.notify_all();
+
+            if (file) std::fclose(file);
+            file = std::fopen(path.c_str(), "wb");
+            return file != nullptr && file_util::syncFile(file);
+        }
+
+
+        // 加载快照后调用, 保证新记录的 lsn 大于快照已包含的 lsn
+        void advanceTo(std::uint64_t lsn) {
+            std::lock_guard<std::mutex> lock(wal_mutex);
+            if (lsn > last_lsn) last_lsn = lsn;
+            if (lsn > durable_lsn) durable_lsn = lsn;
+        }
+
+
+        std::uint64_t lastLsn() {
+            std::lock_guard<std::mutex> lock(wal_mutex);
+            return last_lsn;
+        }
+
+        // 写入的记录数与 fsync 次数, 两者之比即组提交的平均批大小
+        std::uint64_t records() {
+            std::lock_guard<std::mutex> lock(wal_mutex);
+            return record_count;
+        }
+
+        std::uint64_t syncs() {
+            std::lock_guard<std::mutex> lock(wal_mutex);
+            return sync_count;
+        }
+    };
+
+} // namespace wal
@@ -0,0 +1,87 @@
+#include <vector>
+#include <chrono>
+#include <random>
+#include <string>
+#include <algorithm>
+#include "../src/skiplist.h"
+
+
+// 对比逐个调用与批量接口的耗时
+namespace {
+    constexpr int TEST_COUNT = 1000000;
+    constexpr int MAX_HEIGHT = 20;
+
+    using List = skip_list::SkipList<int, int>;
+
+    template<typename F>
+    double timeIt(F&& f) {
+        auto start = std::chrono::high_resolution_clock::now();
+        f();
+        auto finish = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(finish - start).count();
+    }
+
+    void report(const char* name, double per_key, double batch) {
+        std::cout << name << ": per-key " << per_key << " s, batch " << batch
+                  << " s, speedup " << per_key / batch << "x\n";
+    }
+}
+
+
+int main() {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, TEST_COUNT * 4);
+
+    std::vector<std::pair<int, int>> items(TEST_COUNT);
+    std::vector<int> keys(TEST_COUNT);
+    for (int i = 0; i < TEST_COUNT; ++i) {
+        keys[i] = dist(gen);
+        items[i] = {keys[i], i};
+    }
+
+    List per_key_list(MAX_HEIGHT);
+    List batch_list(MAX_HEIGHT);
+
+    // ================= 插入 =================
+    double t1 = timeIt([&] { for (const auto& [k, v] : items) per_key_list.insertNode(k, v); });
+    double t2 = timeIt([&] { batch_list.insertBatch(items); });
+    report("insert", t1, t2);
+
+    // ================= 查找 =================
+    std::shuffle(keys.begin(), keys.end(), gen);
+    std::size_t hits1 = 0, hits2 = 0;
+    t1 = timeIt([&] { for (int k : keys) hits1 += per_key_list.searchNode(k).has_value(); });
+    t2 = timeIt([&] {
+        for (const auto& r : batch_list.searchBatch(keys)) hits2 += r.has_value();
+    });
+    report("search", t1, t2);
+
+    // ================= 删除 =================
+    std::vector<int> victims(keys.begin(), keys.begin() + TEST_COUNT / 2);
+    t1 = timeIt([&] { for (int k : victims) per_key_list.deleteNode(k); });
+    t2 = timeIt([&] { batch_list.deleteBatch(victims); });
+    report("delete", t1, t2);
+
+    // ================= 范围查询 =================
+    // 逐个查找表中每个 key 与一次 rangeScan 顺序读取对比
+    std::vector<int> present;
+    present.reserve(batch_list.size());
+    for (auto [k, v] : batch_list) present.push_back(k);
+    long long sum1 = 0, sum2 = 0;
+    t1 = timeIt([&] { for (int k : present) sum1 += *per_key_list.searchNode(k); });
+    t2 = timeIt([&] { batch_list.rangeScan(0, TEST_COUNT * 4 + 1, [&](int, int v) { sum2 += v; }); });
+    report("range scan", t1, t2);
+
+    // ================= 有序输入构建 =================
+    std::sort(items.begin(), items.end());
+    List inserted_list(MAX_HEIGHT);
+    List built_list(MAX_HEIGHT);
+    t1 = timeIt([&] { for (const auto& [k, v] : items) inserted_list.insertNode(k, v); });
+    t2 = timeIt([&] { built_list.buildFromSorted(items.begin(), items.end()); });
+    report("build from sorted", t1, t2);
+
+    std::cout << "sizes: " << per_key_list.size() << " / " << batch_list.size()
+              << ", hits: " << hits1 << " / " << hits2 << ", sums: " << sum1 << " / " << sum2 << "\n";
+
+    return 0;
+}
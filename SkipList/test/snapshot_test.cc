@@ -0,0 +1,115 @@
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../src/skiplist.h"
+
+
+/*
+ * 快照与预写日志的并发检查:
+ *   1. 后台快照进行时做检查点, 随后继续写入, 再从快照 + 日志恢复, 所有写入都必须还在
+ *   2. 多个线程同时向同一个文件写快照, 结果必须是完整可读的快照, 不留下临时文件
+ *   3. 不覆盖 WAL 位置更新的快照
+ * 全部通过时返回 0。
+ */
+namespace {
+    constexpr int MAX_HEIGHT = 18;
+    constexpr int BATCH = 20000;
+
+    using List = skip_list::SkipList<int, int>;
+    namespace fs = std::filesystem;
+
+    int failures = 0;
+
+    void check(bool ok, const char* what) {
+        std::cout << (ok ? "[ok]   " : "[FAIL] ") << what << "\n";
+        if (!ok) ++failures;
+    }
+
+    void insertRange(List& list, int begin, int end) {
+        std::vector<std::pair<int, int>> items;
+        for (int k = begin; k < end; ++k) items.emplace_back(k, k * 3);
+        list.insertBatch(items);
+    }
+
+    bool holdsRange(const List& list, int end) {
+        if (list.size() != end) return false;
+        int expect = 0;
+        for (const auto& [key, value] : list) {
+            if (key != expect || value != key * 3) return false;
+            ++expect;
+        }
+        return expect == end;
+    }
+
+    bool noTempFiles(const fs::path& dir) {
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (entry.path().filename().string().find(".tmp") != std::string::npos) return false;
+        }
+        return true;
+    }
+}
+
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / "skiplist_snapshot_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const std::string snap = (dir / "list.snap").string();
+    const std::string wal = (dir / "list.wal").string();
+
+    {
+        List list(MAX_HEIGHT);
+        list.openWal(wal);
+        insertRange(list, 0, BATCH);
+        auto background = list.dumpFileAsync(snap);     // 快照位于第一批之后
+        insertRange(list, BATCH, 2 * BATCH);
+        bool checkpointed = list.checkpoint(snap);       // 等待后台快照, 再写入更新的快照并清空日志
+        check(background.get().ok, "background snapshot finished");
+        check(checkpointed, "checkpoint during background snapshot");
+        insertRange(list, 2 * BATCH, 3 * BATCH);         // 只存在于日志中
+    }
+    {
+        List recovered(MAX_HEIGHT);
+        recovered.openWal(wal);
+        check(recovered.loadFile(snap) && holdsRange(recovered, 3 * BATCH), "recovery keeps every acknowledged write");
+    }
+
+    {
+        List list(MAX_HEIGHT);
+        insertRange(list, 0, BATCH);
+        fs::remove(snap);
+        std::vector<std::thread> writers;
+        std::atomic<int> written{0};
+        for (int t = 0; t < 4; ++t) {
+            writers.emplace_back([&] {
+                if (list.dumpFile(snap)) ++written;
+            });
+        }
+        auto background = list.dumpFileAsync(snap);
+        for (auto& w : writers) w.join();
+        background.wait();
+        List loaded(MAX_HEIGHT);
+        check(written == 4 && loaded.loadFile(snap) && holdsRange(loaded, BATCH), "concurrent snapshots of one file");
+        check(noTempFiles(dir), "no temporary files left behind");
+    }
+
+    {
+        // snap 目前的 WAL 位置为 0; 写入一个带日志位置的快照后, 不带日志的快照不能再覆盖它
+        List logged(MAX_HEIGHT);
+        logged.openWal((dir / "other.wal").string());
+        insertRange(logged, 0, 10);
+        check(logged.dumpFile(snap), "newer snapshot replaces older one");
+        List plain(MAX_HEIGHT);
+        insertRange(plain, 0, 5);
+        check(!plain.dumpFile(snap), "older snapshot does not replace newer one");
+        List loaded(MAX_HEIGHT);
+        check(loaded.loadFile(snap) && holdsRange(loaded, 10), "newer snapshot kept");
+    }
+
+    fs::remove_all(dir);
+    std::cout << (failures == 0 ? "all passed" : "FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}